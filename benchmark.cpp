@@ -0,0 +1,283 @@
+#include "simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Times the FTL hot paths in isolation. Every (method, geometry, fill)
+// state is built through the Simulator API: the first fill of the logic
+// space is written in order, a quarter of it is rewritten at random, then
+// the background intervals are pushed out so no task runs while timing.
+// The ops run in batches of doubling size until minTime (s) is spent.
+//
+// usage: benchmark [minTime] [outputFile]
+//
+// output: function method numBlock fill numOp ns/op allocs/op
+//         sorted by function, method & fill, numBlock grows down a curve
+//
+// findfree returns the block to the free list in the same op; findfreePage
+// maps without programming and gc collects the existing state, both run
+// last on a state. The dead SSD::gc (no method reaches it) is not timed.
+
+static std::atomic<long long> g_allocCount(0);
+// the lookups feed it, so the compiler cannot drop them
+static volatile long long g_sink = 0;
+
+// kept out of line, gcc would see the inlined free() as a mismatched delete
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void *operator new(std::size_t size) {
+    ++g_allocCount;
+    void *ptr = malloc(size > 0 ? size : 1);
+    if (ptr == NULL) throw std::bad_alloc();
+    return ptr;
+}
+
+BENCH_NOINLINE void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+struct BenchGeometry {
+    int blockPerLine;
+    int linePerLevel;
+    int levelPerChip;
+};
+
+struct BenchResult {
+    std::string function;
+    std::string method;
+    int numBlock;
+    double fill;
+    long long numOp;
+    double nsPerOp;
+    double allocPerOp;
+
+    bool operator<(const BenchResult &other) const {
+        if (function != other.function) return function < other.function;
+        if (method != other.method) return method < other.method;
+        if (fill != other.fill) return fill < other.fill;
+        return numBlock < other.numBlock;
+    }
+};
+
+static double g_minTime = 0.2;
+static const long long MAXOP = 1LL << 24;
+
+// opFunc(opIndex) returns false once the state can't take another op
+template <typename OpFunc>
+static void measure(OpFunc opFunc, long long maxOp, BenchResult &result) {
+    typedef std::chrono::steady_clock Clock;
+
+    long long numOp = 0, numAlloc = 0;
+    double elapsed = 0;
+    bool isExhausted = false;
+    for (long long batch = 1; elapsed < g_minTime && numOp < maxOp && isExhausted == false; batch *= 2) {
+        long long endOp = std::min(maxOp, numOp + batch), opIndex = numOp;
+        long long allocBegin = g_allocCount.load(std::memory_order_relaxed);
+        Clock::time_point begin = Clock::now();
+        for (; opIndex < endOp; ++opIndex) {
+            if (opFunc(opIndex) == false) {
+                isExhausted = true;
+                break;
+            }
+        }
+        elapsed += std::chrono::duration<double>(Clock::now() - begin).count();
+        numAlloc += g_allocCount.load(std::memory_order_relaxed) - allocBegin;
+        numOp = opIndex;
+    }
+
+    result.numOp = numOp;
+    result.nsPerOp = numOp > 0 ? elapsed * 1e9 / numOp : 0;
+    result.allocPerOp = numOp > 0 ? static_cast<double>(numAlloc) / numOp : 0;
+}
+
+static Simulator *buildState(const std::string &methodNum, const BenchGeometry &geometry, double fill) {
+    SimulatorConfig config;
+    config.m_methodNum = methodNum;
+    config.m_blockPerLine = geometry.blockPerLine;
+    config.m_linePerLevel = geometry.linePerLevel;
+    config.m_levelPerChip = geometry.levelPerChip;
+    config.m_randomSeed = 1;
+
+    Simulator *simulator = Simulator::create(config);
+    if (simulator == NULL) return NULL;
+
+    Executor *executor = simulator->getExecutor();
+    int numPage = static_cast<int>(fill * executor->m_logicBlock * executor->m_pagePerBlock);
+    simulator->submit(SIM_WRITE, 0, numPage);
+
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> distribution(0, numPage - 1);
+    for (int index = 0; index < numPage / 4; ++index) {
+        simulator->submit(SIM_WRITE, distribution(generator));
+    }
+
+    const int NEVER = std::numeric_limits<int>::max();
+    executor->m_scanTemperInterval = NEVER;
+    executor->m_dissTemperInterval = NEVER;
+    executor->m_createErrInterval = NEVER;
+    executor->m_calErrInterval = NEVER;
+    executor->m_migrateInterval = 0;
+    executor->m_scrubInterval = 0;
+    return simulator;
+}
+
+static int countChain(SSD *ssd) {
+    int numChain = 0;
+    for (int logicBlock = 0; logicBlock < ssd->m_logicBlock; ++logicBlock) {
+        int primary = ssd->m_entryTable[logicBlock];
+        if (primary != -1 && ssd->m_replaceTable[primary] != -1) ++numChain;
+    }
+    return numChain;
+}
+
+static void benchState(const std::string &methodNum, const BenchGeometry &geometry, double fill,
+                       std::vector<BenchResult> &resultList) {
+    Simulator *simulator = buildState(methodNum, geometry, fill);
+    if (simulator == NULL) return;
+    Executor *executor = simulator->getExecutor();
+    SSD *ssd = executor->m_ssd;
+
+    BenchResult result;
+    result.method = methodNum;
+    result.numBlock = ssd->m_physicBlock;
+    result.fill = fill;
+
+    // written logic pages, visited in random order
+    const int NUMLOOKUP = 4096;
+    int numPage = static_cast<int>(fill * ssd->m_logicBlock * executor->m_pagePerBlock);
+    std::vector<int> lookupList(NUMLOOKUP);
+    std::mt19937 generator(2);
+    std::uniform_int_distribution<int> distribution(0, numPage - 1);
+    for (int index = 0; index < NUMLOOKUP; ++index) lookupList[index] = distribution(generator);
+
+    long long sink = 0;
+
+    // 0, thermal & error model, the same for every method
+    if (methodNum == std::string("1")) {
+        result.function = "disspateTemper";
+        measure([&](long long) { executor->disspateTemper(); return true; }, MAXOP, result);
+        resultList.push_back(result);
+
+        result.function = "injectErr";
+        measure([&](long long) { executor->injectErr(); return true; }, MAXOP, result);
+        resultList.push_back(result);
+
+        result.function = "statisticErr";
+        measure([&](long long) { executor->statisticErr(); return true; }, MAXOP, result);
+        resultList.push_back(result);
+    }
+
+    // 1, free block pick, given back right away; a full state sits at the
+    //    reserve, the reserve check is lowered to time the pick itself
+    result.function = "findfree";
+    int minimumFreeBlock = ssd->m_minimumFreeBlock;
+    ssd->m_minimumFreeBlock = 1;
+    measure([&](long long) {
+        int freeBlock = ssd->findfree();
+        if (freeBlock == -1) return false;
+        ssd->m_freeBlock.push_back(freeBlock);
+        ssd->m_blockData[freeBlock]->setIsFree(true);
+        return true;
+    }, MAXOP, result);
+    ssd->m_minimumFreeBlock = minimumFreeBlock;
+    resultList.push_back(result);
+
+    // 2, read path lookup
+    result.function = "logic2physic";
+    measure([&](long long opIndex) {
+        int phyBlock = -1, phyPage = -1;
+        ssd->logic2physic(lookupList[opIndex % NUMLOOKUP], phyBlock, phyPage);
+        sink += phyBlock + phyPage;
+        return true;
+    }, MAXOP, result);
+    resultList.push_back(result);
+
+    // 3, collect until nothing is left; SSD_1::gc merges one chain of 2 or
+    //    3 blocks per call and tells whether gcChain was the one merged
+    result.function = "gc";
+    bool isChainMapped = methodNum == std::string("1") || methodNum == std::string("2");
+    measure([&](long long) {
+        std::vector<int> gcChain;
+        bool isCollected = ssd->gc(gcChain, -1);
+        return isChainMapped || isCollected;
+    }, isChainMapped ? countChain(ssd) : MAXOP, result);
+    resultList.push_back(result);
+
+    // 4, write path lookup
+    result.function = "findfreePage";
+    measure([&](long long opIndex) {
+        int phyBlock = -1, phyPage = -1;
+        bool isFound = ssd->findfreePage(lookupList[opIndex % NUMLOOKUP], phyBlock, phyPage);
+        sink += phyBlock + phyPage;
+        return isFound;
+    }, MAXOP, result);
+    resultList.push_back(result);
+
+    g_sink = sink;
+    delete simulator;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        std::cerr << "usage: " << argv[0] << " [minTime] [outputFile]" << std::endl;
+        return 1;
+    }
+    if (argc > 1) g_minTime = atof(argv[1]);
+
+    const char *methodList[] = {"1", "2", "3", "4"};
+    const int numMethod = sizeof(methodList) / sizeof(methodList[0]);
+    const BenchGeometry geometryList[] = {{8, 8, 4}, {16, 8, 8}, {32, 16, 8}};
+    const int numGeometry = sizeof(geometryList) / sizeof(geometryList[0]);
+    const double fillList[] = {0.5, 0.9};
+    const int numFill = sizeof(fillList) / sizeof(fillList[0]);
+
+    std::vector<BenchResult> resultList;
+    for (int methodIndex = 0; methodIndex < numMethod; ++methodIndex) {
+        for (int geometryIndex = 0; geometryIndex < numGeometry; ++geometryIndex) {
+            for (int fillIndex = 0; fillIndex < numFill; ++fillIndex) {
+                benchState(methodList[methodIndex], geometryList[geometryIndex],
+                           fillList[fillIndex], resultList);
+                std::cerr << "method " << methodList[methodIndex]
+                          << " geometry " << geometryIndex
+                          << " fill " << fillList[fillIndex] << " over" << std::endl;
+            }
+        }
+    }
+    std::sort(resultList.begin(), resultList.end());
+
+    std::ostringstream tableStream;
+    tableStream << "function\tmethod\tnumBlock\tfill\tnumOp\tns/op\tallocs/op\n";
+    for (size_t index = 0; index < resultList.size(); ++index) {
+        const BenchResult &result = resultList[index];
+        tableStream << result.function << "\t" << result.method << "\t"
+                    << result.numBlock << "\t" << result.fill << "\t"
+                    << result.numOp << "\t" << result.nsPerOp << "\t"
+                    << result.allocPerOp << "\n";
+    }
+    std::cout << tableStream.str();
+
+    if (argc > 2) {
+        std::ofstream outStream;
+        outStream.open(argv[2], std::ios_base::out);
+        if (outStream.is_open() == false) {
+            std::cerr << "Fail open " << argv[2] << std::endl;
+            return 2;
+        }
+        outStream << tableStream.str();
+        outStream.close();
+    }
+    return 0;
+}
@@ -1,38 +1,202 @@
 #include "ftl.h"
+#include "profile.h"
+#include "telemetry.h"
 
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <thread>
 
 
 const static double LOWESTGAP = 1e-6;
+const static int ERASE_HIST_BUCKET = 16;
+
+// trailing parameters of the configure file are optional,
+// the default value is kept if the stream runs out
+template <typename T>
+static bool readOptional(std::ifstream &inStream, T &value) {
+    T tmpValue;
+    if (!(inStream >> tmpValue)) return false;
+    value = tmpValue;
+    return true;
+}
+
+/**
+ * @brief OpCauseScope : the flash operations within the scope are counted
+ *                       for the cause, the outer cause comes back after
+ */
+class OpCauseScope {
+public:
+    OpCauseScope(SSD *ssd, int opCause) : m_ssd(ssd), m_outerCause(ssd->m_opCause) {
+        m_ssd->m_opCause = opCause;
+    }
+    ~OpCauseScope() {
+        m_ssd->m_opCause = m_outerCause;
+    }
+private:
+    SSD *m_ssd;
+    int m_outerCause;
+};
+
+// ====================CounterRandom=========================
+const static uint32_t PHILOX_M0 = 0xD2511F53, PHILOX_M1 = 0xCD9E8D57,
+        PHILOX_W0 = 0x9E3779B9, PHILOX_W1 = 0xBB67AE85;
+const static int PHILOX_ROUND = 10;
+
+CounterRandom::CounterRandom(uint64_t seed, uint32_t stream, uint32_t epoch) :
+    m_resultIndex(4) {
+    m_key[0] = static_cast<uint32_t>(seed);
+    m_key[1] = static_cast<uint32_t>(seed >> 32);
+    m_counter[0] = m_counter[1] = 0;
+    m_counter[2] = stream;
+    m_counter[3] = epoch;
+}
+
+void CounterRandom::generate() {
+    uint32_t counter[4] = {m_counter[0], m_counter[1], m_counter[2], m_counter[3]},
+            key[2] = {m_key[0], m_key[1]};
+
+    for (int round = 0; round < PHILOX_ROUND; ++round) {
+        uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * counter[0],
+                product1 = static_cast<uint64_t>(PHILOX_M1) * counter[2];
+        uint32_t hi0 = static_cast<uint32_t>(product0 >> 32), lo0 = static_cast<uint32_t>(product0),
+                hi1 = static_cast<uint32_t>(product1 >> 32), lo1 = static_cast<uint32_t>(product1);
+
+        counter[0] = hi1 ^ counter[1] ^ key[0];
+        counter[1] = lo1;
+        counter[2] = hi0 ^ counter[3] ^ key[1];
+        counter[3] = lo0;
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    for (int index = 0; index < 4; ++index) m_result[index] = counter[index];
+
+    // 64-bit draw counter
+    if (++m_counter[0] == 0) ++m_counter[1];
+    m_resultIndex = 0;
+}
+
+uint32_t CounterRandom::next() {
+    if (m_resultIndex >= 4) generate();
+    return m_result[m_resultIndex++];
+}
+
+int CounterRandom::uniformInt(int bound) {
+    return static_cast<int>((static_cast<uint64_t>(next()) * bound) >> 32);
+}
+
+double CounterRandom::uniformReal() {
+    return next() * (1.0 / 4294967296.0);
+}
+
+#ifndef FTL_SEED
+#define FTL_SEED 0
+#endif
+
+uint64_t defaultSeed() {
+    uint64_t seed = static_cast<uint64_t>(FTL_SEED);
+    if (seed == 0) seed = static_cast<uint64_t>(time(NULL));
+    return seed;
+}
 
 // ====================PageData=========================
-bool PageData::m_isRealData = false;
-int PageData::m_bytePerPage = 4096;
 
-PageData::PageData() : m_realPageData(NULL), m_notRealPageData(0),
+PageData::PageData(const DataContext *context) : m_context(context),
+    m_flipBit(NULL), m_hasRealData(false), m_notRealPageData(0),
+    m_errBitCount(0), m_block(NULL),
     m_isValid(false), m_isFree(true), m_realPageNum(-1) {
 }
 
 PageData::~PageData() {
-    if (m_realPageData) delete m_realPageData;
+    if (m_flipBit) delete[] m_flipBit;
+}
+
+// popcount over 64-bit words, the compiler maps it to POPCNT / vector code
+static int countBit(const char *data, int numByte) {
+    int numBit = 0, byteIndex = 0;
+    uint64_t word;
+    for (; byteIndex + 8 <= numByte; byteIndex += 8) {
+        memcpy(&word, data + byteIndex, 8);
+        numBit += __builtin_popcountll(word);
+    }
+    for (; byteIndex < numByte; ++byteIndex) {
+        numBit += __builtin_popcount(static_cast<unsigned char>(data[byteIndex]));
+    }
+    return numBit;
+}
+
+// the flip list grows by power of two, from 4 offsets
+static int flipBitCapacity(int numFlip) {
+    if (numFlip <= 0) return 0;
+    int capacity = 4;
+    while (capacity < numFlip) capacity <<= 1;
+    return capacity;
+}
+
+void PageData::reserveFlipBit(int numFlip) {
+    if (m_flipBit != NULL && flipBitCapacity(numFlip) <= flipBitCapacity(m_errBitCount)) return;
+
+    int *flipBit = new int[flipBitCapacity(numFlip)];
+    if (m_flipBit) {
+        memcpy(flipBit, m_flipBit, sizeof(int) * m_errBitCount);
+        delete[] m_flipBit;
+    }
+    m_flipBit = flipBit;
+}
+
+void PageData::setErrCount(int errCount) {
+    int oldCount = getErrCount();
+    if (m_context->m_isRealData) m_errBitCount = errCount;
+    else m_notRealPageData = errCount;
+
+    if (m_block) m_block->updateErrCount(oldCount, errCount);
+}
+
+int PageData::getErrCount() {
+    return m_context->m_isRealData ? m_errBitCount : m_notRealPageData;
+}
+
+void PageData::correctData() {
+    if (m_context->m_isRealData) {
+        if (m_flipBit) delete[] m_flipBit;
+        m_flipBit = NULL;
+    }
+    setErrCount(0);
+}
+
+void PageData::setOwner(BlockData *block) {
+    m_block = block;
 }
 
 void PageData::clearData() {
-    if (m_realPageData) {
-        delete m_realPageData;
+    if (m_flipBit) {
+        delete[] m_flipBit;
     }
-    m_realPageData = NULL;
-    m_notRealPageData = 0;
+    m_flipBit = NULL;
+    m_hasRealData = false;
+    setErrCount(0);
 }
 
 void PageData::copyData(const PageData *source) {
     if (source == NULL) return;
 
-    if (m_isRealData) {
-        assert(m_bytePerPage > 0);
-        m_realPageData = m_realPageData ? m_realPageData : new char[m_bytePerPage];
-        strncpy(m_realPageData, source->m_realPageData, m_bytePerPage);
+    if (m_context->m_isRealData) {
+        if (source->m_hasRealData == false) {
+            clearData();
+            return;
+        }
+        if (m_flipBit) delete[] m_flipBit;
+        m_flipBit = NULL;
+        if (source->m_errBitCount > 0) {
+            m_flipBit = new int[flipBitCapacity(source->m_errBitCount)];
+            memcpy(m_flipBit, source->m_flipBit, sizeof(int) * source->m_errBitCount);
+        }
+        m_hasRealData = true;
+        setErrCount(source->m_errBitCount);
+    } else {
+        setErrCount(source->m_notRealPageData);
     }
-    m_notRealPageData = source->m_notRealPageData;
 }
 
 void PageData::mvData(PageData *source) {
@@ -44,16 +208,19 @@ void PageData::mvData(PageData *source) {
 
 bool PageData::getDataAsBit(char *realPageData) {
     if (realPageData == NULL ||
-            m_isRealData == false ||
-            m_realPageData == NULL) {
+            m_context->m_isRealData == false ||
+            m_hasRealData == false) {
         return false;
     }
-    strncpy(realPageData, m_realPageData, m_bytePerPage);
+    memset(realPageData, 0, m_context->m_bytePerPage);
+    for (int flipIndex = 0; flipIndex < m_errBitCount; ++flipIndex) {
+        realPageData[m_flipBit[flipIndex] / 8] |= static_cast<char>(1 << (m_flipBit[flipIndex] % 8));
+    }
     return true;
 }
 
 bool PageData::getDataAsErrCount(int &notRealData) {
-    if (m_isRealData) {
+    if (m_context->m_isRealData) {
         return false;
     }
     notRealData = m_notRealPageData;
@@ -61,21 +228,65 @@ bool PageData::getDataAsErrCount(int &notRealData) {
 }
 
 bool PageData::setDataAsBit(const char *realPageData) {
-    if (realPageData == NULL || m_isRealData == false) {
+    if (realPageData == NULL || m_context->m_isRealData == false) {
         return false;
     }
 
-    assert(m_bytePerPage > 0);
-    m_realPageData = m_realPageData ? m_realPageData : new char[m_bytePerPage];
-    strncpy(m_realPageData, realPageData, m_bytePerPage);
+    assert(m_context->m_bytePerPage > 0);
+    int numFlip = countBit(realPageData, m_context->m_bytePerPage);
+    if (m_flipBit) delete[] m_flipBit;
+    m_flipBit = numFlip > 0 ? new int[flipBitCapacity(numFlip)] : NULL;
+
+    // collect the offsets word by word, zero words are skipped at once
+    int flipIndex = 0, byteIndex = 0;
+    uint64_t word;
+    for (; byteIndex + 8 <= m_context->m_bytePerPage && flipIndex < numFlip; byteIndex += 8) {
+        memcpy(&word, realPageData + byteIndex, 8);
+        for (; word != 0; word &= word - 1) {
+            // little endian: bit b of the word is bit b % 8 of byte b / 8
+            m_flipBit[flipIndex++] = byteIndex * 8 + __builtin_ctzll(word);
+        }
+    }
+    for (; byteIndex < m_context->m_bytePerPage && flipIndex < numFlip; ++byteIndex) {
+        for (int bitIndex = 0; bitIndex < 8; ++bitIndex) {
+            if (realPageData[byteIndex] & (1 << bitIndex)) m_flipBit[flipIndex++] = byteIndex * 8 + bitIndex;
+        }
+    }
+
+    m_hasRealData = true;
+    setErrCount(numFlip);
     return true;
 }
 
 bool PageData::setDataAsErrCount(int notRealData) {
-    if (m_isRealData == true || notRealData < 0) {
+    if (m_context->m_isRealData == true || notRealData < 0) {
+        return false;
+    }
+    setErrCount(notRealData);
+    return true;
+}
+
+bool PageData::flipBit(int bitIndex) {
+    if (m_context->m_isRealData == false || m_hasRealData == false ||
+            bitIndex < 0 || bitIndex >= m_context->m_bytePerPage * 8) {
         return false;
     }
-    m_notRealPageData = notRealData;
+
+    int *flipEnd = m_flipBit + m_errBitCount,
+            *flipPos = std::lower_bound(m_flipBit, flipEnd, bitIndex);
+    if (flipPos != flipEnd && *flipPos == bitIndex) {
+        // the bit goes back to 0
+        memmove(flipPos, flipPos + 1, sizeof(int) * (flipEnd - flipPos - 1));
+        setErrCount(m_errBitCount - 1);
+        return true;
+    }
+
+    int insertIndex = flipPos - m_flipBit;
+    reserveFlipBit(m_errBitCount + 1);
+    memmove(m_flipBit + insertIndex + 1, m_flipBit + insertIndex,
+            sizeof(int) * (m_errBitCount - insertIndex));
+    m_flipBit[insertIndex] = bitIndex;
+    setErrCount(m_errBitCount + 1);
     return true;
 }
 
@@ -110,28 +321,31 @@ int PageData::getRealPageNum() {
 }
 
 // ====================BlockData=========================
-int BlockData::m_pagePerBlock = 0;
 
-BlockData::BlockData() : m_temper(25), m_eraseCount(0), m_isFree(true) {
-    assert(m_pagePerBlock > 0);
-    m_pageData = new PageData*[m_pagePerBlock];
-    for (int pageIndex = 0; pageIndex < m_pagePerBlock; ++pageIndex) {
-        m_pageData[pageIndex] = new PageData;
+BlockData::BlockData(const DataContext *context) : m_context(context),
+    m_errCount(0), m_errOverEcc(0),
+    m_temper(25), m_eraseCount(0), m_isFree(true), m_programTime(-1),
+    m_errDose(0), m_doseTime(0), m_settleEpoch(0) {
+    assert(m_context->m_pagePerBlock > 0);
+    m_pageData = new PageData*[m_context->m_pagePerBlock];
+    for (int pageIndex = 0; pageIndex < m_context->m_pagePerBlock; ++pageIndex) {
+        m_pageData[pageIndex] = new PageData(m_context);
+        m_pageData[pageIndex]->setOwner(this);
     }
 }
 
 BlockData::~BlockData() {
-    for (int pageIndex = 0; pageIndex < m_pagePerBlock; ++pageIndex) {
+    for (int pageIndex = 0; pageIndex < m_context->m_pagePerBlock; ++pageIndex) {
         delete m_pageData[pageIndex];
     }
-    delete m_pageData;
+    delete[] m_pageData;
 
 }
 
 
 
 void BlockData::clearData() {
-    for (int index = 0; index < m_pagePerBlock; ++index) {
+    for (int index = 0; index < m_context->m_pagePerBlock; ++index) {
         m_pageData[index]->clearData();
     }
 }
@@ -139,7 +353,7 @@ void BlockData::clearData() {
 void BlockData::copyData(BlockData *blockdata) {
     if (blockdata == NULL) return;
 
-    for (int index = 0; index < m_pagePerBlock ; ++index) {
+    for (int index = 0; index < m_context->m_pagePerBlock ; ++index) {
         if (blockdata->m_pageData[index]) {
             m_pageData[index]->copyData(blockdata->m_pageData[index]);
         }
@@ -154,7 +368,7 @@ void BlockData::mvData(BlockData *blockdata) {
 
 
 PageData *BlockData::getPage(int pageNum) {
-    if (pageNum < 0 || pageNum >= m_pagePerBlock) {
+    if (pageNum < 0 || pageNum >= m_context->m_pagePerBlock) {
         std::cerr << "The pageNum is illegal !!!" << std::endl;
         return NULL;
     }
@@ -162,7 +376,7 @@ PageData *BlockData::getPage(int pageNum) {
 }
 
 bool BlockData::getPageData(int offset, PageData &pagedata) {
-    if (offset < 0 || offset >= m_pagePerBlock) {
+    if (offset < 0 || offset >= m_context->m_pagePerBlock) {
         std::cerr << "The page num is ilegal !!!" << std::endl;
         return false;
     }
@@ -172,7 +386,7 @@ bool BlockData::getPageData(int offset, PageData &pagedata) {
 }
 
 bool BlockData::setPageData(int offset, const PageData &pagedata) {
-    if (offset < 0 || offset >= m_pagePerBlock) {
+    if (offset < 0 || offset >= m_context->m_pagePerBlock) {
         std::cerr << "The page num is ilegal !!!" << std::endl;
         return false;
     }
@@ -207,22 +421,79 @@ int BlockData::getEraseCount() {
 
 void BlockData::setIsFree(bool isFree) {
     m_isFree = isFree;
+    if (isFree) {
+        m_programTime = -1;
+        m_errDose = 0;
+    }
 }
 
 bool BlockData::getIsFree() {
     return m_isFree;
 }
 
+
+
+void BlockData::markProgram(double time) {
+    if (m_programTime < 0) {
+        m_programTime = time;
+        m_errDose = 0;
+        m_doseTime = time;
+    }
+}
+
+double BlockData::getProgramTime() {
+    return m_programTime;
+}
+
+void BlockData::setErrDose(double errDose, double doseTime) {
+    m_errDose = errDose;
+    m_doseTime = doseTime;
+}
+
+double BlockData::getErrDose() {
+    return m_errDose;
+}
+
+double BlockData::getDoseTime() {
+    return m_doseTime;
+}
+
+uint32_t BlockData::nextSettleEpoch() {
+    return m_settleEpoch++;
+}
+
+
+
+void BlockData::updateErrCount(int oldCount, int newCount) {
+    m_errCount += newCount - oldCount;
+    if (oldCount > m_context->m_eccNumBit) m_errOverEcc -= oldCount;
+    if (newCount > m_context->m_eccNumBit) m_errOverEcc += newCount;
+}
+
+long long BlockData::getErrCount() {
+    return m_errCount;
+}
+
+long long BlockData::getErrOverEcc() {
+    return m_errOverEcc;
+}
+
 // ====================SSD=========================
 
 // note: if m_executor != NULL, all space should-be allocated
 
-int SSD::m_logicBlock = 0;
-int SSD::m_physicBlock = 0;
-int SSD::m_minimumFreeBlock = 1;
 
-SSD::SSD() : m_executor(NULL), m_blockData(NULL),
-    m_entryTable(NULL), m_replaceTable(NULL) {
+SSD::SSD() : m_logicBlock(0), m_physicBlock(0), m_minimumFreeBlock(1),
+    m_executor(NULL), m_blockData(NULL),
+    m_entryTable(NULL), m_replaceTable(NULL),
+    m_logicHeatSum(0), m_allocLogicBlock(-1), m_hotAllocCount(0), m_hostWrite(0),
+    m_opCause(OPCAUSE_HOST),
+    m_gcCount(0), m_switchMerge(0), m_partialMerge(0), m_fullMerge(0), m_gcCopyPage(0), m_gcTime(0) {
+    for (int cause = 0; cause < NUMOPCAUSE; ++cause) {
+        for (int opIndex = 0; opIndex < NUMFLASHOP; ++opIndex) {
+            m_flashOp[cause][opIndex] = 0;
+        }
+    }
 }
 
 SSD::~SSD() {
@@ -238,16 +509,21 @@ void SSD::allocateSpace(Executor *executor) {
     m_executor = executor;
 
     // set variation
-    PageData::m_bytePerPage = m_executor->m_bytePerPage;
-    PageData::m_isRealData = m_executor->m_isRealData;
-    BlockData::m_pagePerBlock = m_executor->m_pagePerBlock;
+    m_dataContext.m_bytePerPage = m_executor->m_bytePerPage;
+    m_dataContext.m_isRealData = m_executor->m_isRealData;
+    m_dataContext.m_pagePerBlock = m_executor->m_pagePerBlock;
+    m_dataContext.m_eccNumBit = m_executor->m_eccNumBit;
+    m_dataContext.m_pageShift = -1;
+    for (int shift = 0; shift < 31; ++shift) {
+        if ((1 << shift) == m_dataContext.m_pagePerBlock) m_dataContext.m_pageShift = shift;
+    }
 
     m_logicBlock = m_executor->m_logicBlock;
     m_physicBlock = m_executor->m_physicBlock;
     m_minimumFreeBlock = m_executor->m_minimumFreeBlock;
 
-    assert(PageData::m_bytePerPage > 0);
-    assert(BlockData::m_pagePerBlock > 0);
+    assert(m_dataContext.m_bytePerPage > 0);
+    assert(m_dataContext.m_pagePerBlock > 0);
     assert(m_logicBlock > 0);
     assert(m_physicBlock > 0);
     assert(m_minimumFreeBlock >= 1);
@@ -255,7 +531,7 @@ void SSD::allocateSpace(Executor *executor) {
     // allocate spaceee
     m_blockData = new BlockData*[m_physicBlock];
     for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
-        m_blockData[blockIndex] = new BlockData;
+        m_blockData[blockIndex] = new BlockData(&m_dataContext);
     }
 
     m_entryTable = new int[m_logicBlock];
@@ -266,6 +542,10 @@ void SSD::allocateSpace(Executor *executor) {
     for (int index = 0; index < m_physicBlock; ++index) {
         m_replaceTable[index] = -1;
     }
+
+    m_logicHeat.assign(m_logicBlock, 0);
+    m_logicHeatSum = 0;
+    initDissipateScore();
 }
 
 bool SSD::initTable(std::string filename, std::string tablename) {
@@ -411,7 +691,7 @@ bool SSD::initMetaData(std::string filename) {
         blockData->setIsFree(blockIsFree == 0 ? false : true);
 
         // page meta data
-        for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+        for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
             pageData = blockData->getPage(pageIndex);
             inStream >> pageIsValid >> pageIsFree >> realPageNum;
 
@@ -442,7 +722,7 @@ bool SSD::writeBackMetaData(std::string filename) {
                         << (blockData->getIsFree() ? 1 : 0) << " ";
 
         // page meta data
-        for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+        for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
             pageData = blockData->getPage(pageIndex);
 
             outStream << (pageData->getValid() ? 1 : 0) << " "
@@ -474,7 +754,7 @@ bool SSD::initBlockData(std::string filenamePrefix) {
         filenameStream << filenamePrefix << "_" << levelIndex;
         filename = filenameStream.str();
 
-        if (PageData::m_isRealData) {
+        if (m_dataContext.m_isRealData) {
             inStream.open(filename.c_str(), std::ios_base::in | std::ios_base::binary);
         } else {
             inStream.open(filename.c_str(), std::ios_base::in);
@@ -507,16 +787,16 @@ bool SSD::writeBackBlockData(std::string filenamePrefix) {
         filenameStream << filenamePrefix << "_" << levelIndex;
         filename = filenameStream.str();
 
-        if (PageData::m_isRealData) {
+        if (m_dataContext.m_isRealData) {
             outStream.open(filename.c_str(), std::ios_base::out | std::ios_base::binary);
         } else {
-            outStream.open(filename.c_str(), std::ios_base::in);
+            outStream.open(filename.c_str(), std::ios_base::out);
         }
 
         if (writeLevelBlockData(outStream, levelIndex) == false) {
-            std::cerr << "Fail write back block data !!!" << std::endl
-                      << "Abort" << std::endl;
-            exit(1);
+            std::cerr << "Fail write back block data !!!" << std::endl;
+            outStream.close();
+            return false;
         }
         outStream.close();
     }
@@ -539,25 +819,129 @@ bool SSD::writeBackSummary(std::string filename) {
 
     // erase count
     int maxEraseCount = 0;
-    double avgEraseCount = 0, maxTemper = 0;
+    double avgEraseCount = 0, maxTemper = 0, sqrEraseCount = 0;
 
     for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
         if (maxEraseCount < m_blockData[blockIndex]->getEraseCount()) {
                 maxEraseCount = m_blockData[blockIndex]->getEraseCount();
         }
         avgEraseCount += m_blockData[blockIndex]->getEraseCount();
+        sqrEraseCount += static_cast<double>(m_blockData[blockIndex]->getEraseCount())
+                * m_blockData[blockIndex]->getEraseCount();
 
         if (maxTemper - m_blockData[blockIndex]->getTemper() < LOWESTGAP) {
             maxTemper = m_blockData[blockIndex]->getTemper();
         }
     }
     avgEraseCount /= m_physicBlock;
+    sqrEraseCount /= m_physicBlock;
 
     outStream << "maxEraseCount = " << maxEraseCount << "\n"
               << "averageEraseCount = " << avgEraseCount << "\n"
               << "maxTemper = " << maxTemper << "\n";
 
+    // thermal throttling
+    outStream << "simulateTime = " << m_executor->m_simulateTime << "\n"
+              << "throttleEvent = " << m_executor->m_throttleEvent << "\n"
+              << "throttleStall = " << m_executor->m_throttleStall << "\n"
+              << "throttleTime = " << m_executor->m_throttleTime << "\n";
+
+    // placement
+    outStream << "hotAllocCount = " << m_hotAllocCount << "\n";
+
+    // gc
+    outStream << "switchMerge = " << m_switchMerge << "\n"
+              << "partialMerge = " << m_partialMerge << "\n"
+              << "fullMerge = " << m_fullMerge << "\n"
+              << "gcCopyPage = " << m_gcCopyPage << "\n"
+              << "gcTime = " << m_gcTime << "\n"
+              << "gcCount = " << m_gcCount << "\n";
+
+    // write amplification, flash operations of every cause as
+    // readOob writeOob readPage program erase
+    const char *causeName[NUMOPCAUSE] = {"host", "gc", "background"};
+    long long opCount[NUMFLASHOP] = {0};
+    for (int cause = 0; cause < NUMOPCAUSE; ++cause) {
+        outStream << causeName[cause] << "FlashOp =";
+        for (int opIndex = 0; opIndex < NUMFLASHOP; ++opIndex) {
+            outStream << " " << m_flashOp[cause][opIndex];
+            opCount[opIndex] += m_flashOp[cause][opIndex];
+        }
+        outStream << "\n";
+    }
+    long long flashProgram = opCount[FLASHOP_PROGRAM];
+    outStream << "flashOpTime =";
+    for (int opIndex = 0; opIndex < NUMFLASHOP; ++opIndex) {
+        outStream << " " << opCount[opIndex] * flashTime(1 << opIndex);
+    }
+    outStream << "\n";
+    // share of the pages erased by gc it did not have to copy
+    long long gcErasePage = m_flashOp[OPCAUSE_GC][FLASHOP_ERASE] * m_dataContext.m_pagePerBlock;
+    outStream << "hostWrite = " << m_hostWrite << "\n"
+              << "flashProgram = " << flashProgram << "\n"
+              << "waf = " << (m_hostWrite > 0 ? static_cast<double>(flashProgram) / m_hostWrite : 0) << "\n"
+              << "gcEfficiency = "
+              << (gcErasePage > 0 ? 1 - static_cast<double>(m_flashOp[OPCAUSE_GC][FLASHOP_PROGRAM]) / gcErasePage : 0) << "\n";
+
+    // wear, bucket i : erase count in [i * width, (i + 1) * width)
+    int eraseHistWidth = maxEraseCount / ERASE_HIST_BUCKET + 1;
+    std::vector<int> eraseHist(maxEraseCount / eraseHistWidth + 1, 0);
+    for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
+        ++eraseHist[m_blockData[blockIndex]->getEraseCount() / eraseHistWidth];
+    }
+    outStream << "eraseHistWidth = " << eraseHistWidth << "\n"
+              << "eraseHist =";
+    for (int bucket = 0; bucket < eraseHist.size(); ++bucket) {
+        outStream << " " << eraseHist[bucket];
+    }
+    outStream << "\n";
+    // coefficient of variation of the erase counts
+    double eraseDeviation = std::sqrt(std::max(0.0, sqrEraseCount - avgEraseCount * avgEraseCount));
+    outStream << "wearSpread = " << (avgEraseCount > 0 ? eraseDeviation / avgEraseCount : 0) << "\n";
+
+    // hotspot migration, compare with a run having the task disabled
+    outStream << "peakTemper = " << m_executor->m_peakTemper << "\n"
+              << "injectErrCount = " << m_executor->m_injectErrCount << "\n"
+              << "migrateChain = " << m_executor->m_migrateChain << "\n"
+              << "migratePage = " << m_executor->m_migratePage << "\n"
+              << "migrateErase = " << m_executor->m_migrateErase << "\n";
+
+    // read path
+    outStream << "readCount = " << m_executor->m_readCount << "\n"
+              << "uncorrectableRead = " << m_executor->m_uncorrectableRead << "\n"
+              << "hardDecodeRead = " << m_executor->m_decodeLevelCount[0] << "\n"
+              << "softDecodeRead = " << m_executor->m_decodeLevelCount[1] << "\n";
+    for (int retryIndex = 2; retryIndex < m_executor->m_decodeLevelCount.size(); ++retryIndex) {
+        outStream << "retry" << retryIndex - 1 << "Read = "
+                  << m_executor->m_decodeLevelCount[retryIndex] << "\n";
+    }
+    outStream << "avgReadLatency = "
+              << (m_executor->m_readCount ? m_executor->m_readLatencySum / m_executor->m_readCount : 0) << "\n"
+              << "maxReadLatency = " << m_executor->m_readLatencyMax << "\n";
+    // bucket i : latency <= readPageTime * 2^(i+1)
+    outStream << "readLatencyHist =";
+    int lastBucket = m_executor->m_readLatencyHist.size() - 1;
+    while (lastBucket > 0 && m_executor->m_readLatencyHist[lastBucket] == 0) --lastBucket;
+    for (int bucket = 0; bucket <= lastBucket; ++bucket) {
+        outStream << " " << m_executor->m_readLatencyHist[bucket];
+    }
+    outStream << "\n";
+
+    // scrubbing
+    outStream << "scrubRun = " << m_executor->m_scrubRun << "\n"
+              << "scrubPageRead = " << m_executor->m_scrubPageRead << "\n"
+              << "scrubRefreshChain = " << m_executor->m_scrubRefreshChain << "\n"
+              << "scrubRefreshPage = " << m_executor->m_scrubRefreshPage << "\n"
+              << "scrubRefreshErase = " << m_executor->m_scrubRefreshErase << "\n"
+              << "scrubNearEccPage = " << m_executor->m_scrubNearEccPage << "\n"
+              << "scrubOverEccPage = " << m_executor->m_scrubOverEccPage << "\n"
+              << "scrubLostPage = " << m_executor->m_scrubLostPage << "\n"
+              << "scrubBusyTime = " << m_executor->m_scrubBusyTime << "\n"
+              << "scrubTimeShare = "
+              << (m_executor->m_simulateTime > 0 ? m_executor->m_scrubBusyTime / m_executor->m_simulateTime : 0) << "\n";
+
     outStream.close();
+    return true;
 }
 
 
@@ -567,45 +951,45 @@ bool SSD::loadLevelBlockData(std::ifstream &inStream, int levelIndex) {
 
     char *dataBit = NULL, *dataBitModel = NULL;
     int dataErrCount = 0;
-    if (PageData::m_isRealData) {
-        dataBit = new char[PageData::m_bytePerPage],
-                dataBitModel = new char[PageData::m_bytePerPage];
-        memset(dataBitModel, 0, PageData::m_bytePerPage);
+    if (m_dataContext.m_isRealData) {
+        dataBit = new char[m_dataContext.m_bytePerPage],
+                dataBitModel = new char[m_dataContext.m_bytePerPage];
+        memset(dataBitModel, 0, m_dataContext.m_bytePerPage);
     }
 
     int startBlock = levelIndex * m_executor->m_blockPerLine * m_executor->m_linePerLevel,
             endBlock = (levelIndex + 1) * m_executor->m_blockPerLine * m_executor->m_linePerLevel;
-    PageData tmpPagedata;
+    PageData tmpPagedata(&m_dataContext);
 
     for (int blockIndex = startBlock; blockIndex < endBlock; ++blockIndex) {
-        for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+        for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
 
-            if (PageData::m_isRealData) {
-                inStream.read(dataBit, PageData::m_bytePerPage);
-                if (memcmp(dataBit, dataBitModel, PageData::m_bytePerPage) == 0) continue;
+            if (m_dataContext.m_isRealData) {
+                inStream.read(dataBit, m_dataContext.m_bytePerPage);
+                if (memcmp(dataBit, dataBitModel, m_dataContext.m_bytePerPage) == 0) continue;
             } else {
                 inStream >> dataErrCount;
                 if (0 == dataErrCount) continue;
             }
 
-            if (PageData::m_isRealData) tmpPagedata.setDataAsBit(dataBit);
+            if (m_dataContext.m_isRealData) tmpPagedata.setDataAsBit(dataBit);
             else tmpPagedata.setDataAsErrCount(dataErrCount);
 
             m_blockData[blockIndex]->setPageData(pageIndex, tmpPagedata);
         }
     }
 
-    if (PageData::m_isRealData) {
-        delete dataBit;
-        delete dataBitModel;
+    if (m_dataContext.m_isRealData) {
+        delete[] dataBit;
+        delete[] dataBitModel;
     }
     return true;
 }
 
 bool SSD::writeLevelBlockData(std::ofstream &outStream, int levelIndex) {
-    if (!outStream.is_open() == false) return false;
+    if (outStream.is_open() == false) return false;
 
-    char *dataBit = PageData::m_isRealData ? new char[PageData::m_bytePerPage] : NULL;
+    char *dataBit = m_dataContext.m_isRealData ? new char[m_dataContext.m_bytePerPage] : NULL;
     int dataErrCount = 0;
 
     int startBlock = levelIndex * m_executor->m_blockPerLine * m_executor->m_linePerLevel,
@@ -613,18 +997,20 @@ bool SSD::writeLevelBlockData(std::ofstream &outStream, int levelIndex) {
 
     PageData *pageData = NULL;
     for (int blockIndex = startBlock; blockIndex < endBlock; ++blockIndex) {
-        for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+        for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
 
             pageData = m_blockData[blockIndex]->getPage(pageIndex);
-            if (PageData::m_isRealData) {
-                pageData->getDataAsBit(dataBit);
-                outStream.write(dataBit, PageData::m_bytePerPage);
+            if (m_dataContext.m_isRealData) {
+                // never programmed pages are written as zero
+                if (pageData->getDataAsBit(dataBit) == false) memset(dataBit, 0, m_dataContext.m_bytePerPage);
+                outStream.write(dataBit, m_dataContext.m_bytePerPage);
             } else {
                 pageData->getDataAsErrCount(dataErrCount);
                 outStream << dataErrCount << " ";
             }
         }
     }
+    if (dataBit) delete[] dataBit;
     return true;
 }
 
@@ -655,42 +1041,55 @@ bool SSD::setExecutor(Executor *executor) {
 
 
 int SSD::readPage(int logicNum, PageData *data) {
+    FTL_PROFILE_SCOPE(PROFILE_READPAGE);
     int phyBlock = -1, phyPage = -1;
+    double startTime = m_executor->m_simulateTime;
     if (data == NULL || logic2physic(logicNum, phyBlock, phyPage) == false) {
         return -1;
     }
 
-//    while (m_blockData[phyBlock]->getTemper() >= 150) {
-//        m_executor->disspateTemper();
-//    }
+    m_executor->throttle(phyBlock);
+    m_executor->settleErr(phyBlock);
     m_blockData[phyBlock]->getPageData(phyPage, *data);
 
     m_executor->checkTemper(phyBlock, m_executor->m_readPageTemper);
-    m_executor->checkTime(m_executor->m_readPageTime);
+    chargeFlash(FLASH_READPAGE);
+
+    m_executor->decodeRead(phyBlock, m_blockData[phyBlock]->getPage(phyPage)->getErrCount());
+    m_executor->recordReadLatency(m_executor->m_simulateTime - startTime);
 
     return phyBlock;
 }
 
 int SSD::writePage(int logicNum, PageData *data) {
+    FTL_PROFILE_SCOPE(PROFILE_WRITEPAGE);
     int phyBlock = -1, phyPage = -1;
-    if (data == NULL || findfreePage(logicNum, phyBlock, phyPage) == false) {
+    if (data == NULL || logicNum < 0 ||
+            logicNum >= m_executor->m_pagePerBlock * m_logicBlock) {
         return -1;
     }
 
-//    while (m_blockData[phyBlock]->getTemper() >= 150) {
-//        m_executor->disspateTemper();
-//    }
+    m_allocLogicBlock = logicBlockOf(logicNum);
+    m_logicHeat[m_allocLogicBlock] += 1;
+    m_logicHeatSum += 1;
+
+    bool isFound = findfreePage(logicNum, phyBlock, phyPage);
+    m_allocLogicBlock = -1;
+    if (isFound == false) return -1;
+
+    m_executor->throttle(phyBlock);
     m_blockData[phyBlock]->setPageData(phyPage, *data);
+    m_blockData[phyBlock]->markProgram(m_executor->m_simulateTime);
 
-    int logicPage = logicNum % BlockData::m_pagePerBlock;
+    int logicPage = logicPageOf(logicNum);
     PageData *pageData = m_blockData[phyBlock]->getPage(phyPage);
     pageData->setIsFree(false);
     pageData->setRealPageNum(logicPage);
     pageData->setValid(true);
 
     m_executor->checkTemper(phyBlock, m_executor->m_writePageTemper);
-    m_executor->checkTime(m_executor->m_writeOobTime +
-                                                m_executor->m_writePageTime);
+    chargeFlash(FLASH_WRITEOOB | FLASH_PROGRAM);
+    ++m_hostWrite;
 
     return phyBlock;
 }
@@ -699,6 +1098,7 @@ int SSD::writePage(int logicNum, PageData *data) {
 
 
 int SSD::findfree() {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREE);
     assert(m_minimumFreeBlock >=1);
     if (m_freeBlock.size() <= m_minimumFreeBlock) return -1;
 
@@ -709,6 +1109,8 @@ int SSD::findfree() {
 }
 
 bool SSD::gc(std::vector<int> &gcChain, int pageNum) {
+    FTL_PROFILE_SCOPE(PROFILE_GC);
+    OpCauseScope opCauseScope(this, OPCAUSE_GC);
 
     // find the longest chain
     std::vector<int> maxChain, tmpChain;
@@ -751,17 +1153,16 @@ bool SSD::gc(std::vector<int> &gcChain, int pageNum) {
         m_freeBlock.push_back(*iterBlock);
 
 
-        m_executor->checkTime(m_executor->m_writeOobTime +
-                                                m_executor->m_eraseBlockTime);
+        chargeFlash(FLASH_WRITEOOB | FLASH_ERASE);
         m_executor->checkTemper(*iterBlock, m_executor->m_eraseBlockTemper);
 
-        for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+        for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
             srcPage = m_blockData[*iterBlock]->getPage(pageIndex);
             srcPage->setIsFree(true);
             srcPage->setRealPageNum(-1);
             srcPage->setValid(false);
 
-            m_executor->checkTime(m_executor->m_writeOobTime);
+            chargeFlash(FLASH_WRITEOOB);
 
             if (originalChainChanged == true && pageIndex == pageNum) {
                 srcPage->clearData();
@@ -775,10 +1176,7 @@ bool SSD::gc(std::vector<int> &gcChain, int pageNum) {
                 targetPage->setRealPageNum(pageIndex);
                 targetPage->setValid(true);
 
-                m_executor->checkTime(m_executor->m_readOobTime +
-                                                            m_executor->m_writeOobTime +
-                                                            m_executor->m_readPageTime +
-                                                            m_executor->m_writePageTime);
+                chargeFlash(FLASH_READOOB | FLASH_WRITEOOB | FLASH_READPAGE | FLASH_PROGRAM);
                 m_executor->checkTemper(*iterBlock, m_executor->m_readPageTemper);
                 m_executor->checkTemper(primary, m_executor->m_writePageTemper);
             }
@@ -801,8 +1199,8 @@ bool SSD::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
         return false;
     }
 
-    int logicBlock = logicNum / m_executor->m_pagePerBlock;
-    phyPage = logicNum % m_executor->m_pagePerBlock;
+    int logicBlock = logicBlockOf(logicNum);
+    phyPage = logicPageOf(logicNum);
 
     // entryTable
     int primaryBlock = m_entryTable[logicBlock];
@@ -810,7 +1208,7 @@ bool SSD::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
 
     while (primaryBlock != -1) {
 
-        m_executor->checkTime(m_executor->m_readOobTime);
+        chargeFlash(FLASH_READOOB);
 
         if (m_blockData[primaryBlock]->getPage(phyPage)->getValid() == true) {
             phyBlock = primaryBlock;
@@ -822,10 +1220,11 @@ bool SSD::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
 }
 
 bool SSD::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREEPAGE);
     assert(m_executor);
 
-    int logicBlock = logicNum / m_executor->m_pagePerBlock;
-    phyPage = logicNum % m_executor->m_pagePerBlock;
+    int logicBlock = logicBlockOf(logicNum);
+    phyPage = logicPageOf(logicNum);
 
     int primaryBlock = m_entryTable[logicBlock];
 
@@ -833,7 +1232,7 @@ bool SSD::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
     while (primaryBlock != -1) {
         gcChain.push_back(primaryBlock);
 
-        m_executor->checkTime(m_executor->m_readOobTime);
+        chargeFlash(FLASH_READOOB);
 
         if (m_blockData[primaryBlock]->getPage(phyPage)->getIsFree() == true) {
             phyBlock = primaryBlock;
@@ -848,7 +1247,8 @@ bool SSD::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
         return true;
     }
 
-    assert((primaryBlock = findfree()) != -1);
+    primaryBlock = findfree();
+    assert(primaryBlock != -1);
 
     if (gcChain.size() == 0) {
         m_entryTable[logicBlock] = primaryBlock;
@@ -879,6 +1279,16 @@ bool SSD::linear2threeDimesion(int linear, int &x, int &y, int &z) {
     return true;
 }
 
+int SSD::logicBlockOf(int logicNum) {
+    if (m_dataContext.m_pageShift >= 0) return logicNum >> m_dataContext.m_pageShift;
+    return logicNum / m_dataContext.m_pagePerBlock;
+}
+
+int SSD::logicPageOf(int logicNum) {
+    if (m_dataContext.m_pageShift >= 0) return logicNum & (m_dataContext.m_pagePerBlock - 1);
+    return logicNum % m_dataContext.m_pagePerBlock;
+}
+
 bool SSD::threeDimension2linear(int x, int y, int z, int &linear) {
     assert(m_executor);
     if (x < 0 || x >= m_executor->m_blockPerLine) {
@@ -900,9 +1310,164 @@ bool SSD::threeDimension2linear(int x, int y, int z, int &linear) {
 }
 
 
+
+void SSD::initDissipateScore() {
+    // a block releases heat to the 25 degree boundary through its nearest
+    // face on every axis, the closer the face the better the conductance
+    m_dissipateScore.assign(m_physicBlock, 0);
+
+    int x, y, z, xGap, yGap, zGap;
+    for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
+        linear2threeDimesion(blockIndex, x, y, z);
+        xGap = std::min(x, m_executor->m_blockPerLine - 1 - x);
+        yGap = std::min(y, m_executor->m_linePerLevel - 1 - y);
+        zGap = std::min(z, m_executor->m_levelPerChip - 1 - z);
+
+        m_dissipateScore[blockIndex] = m_executor->m_lrTemperPercent / (1 + xGap) +
+                m_executor->m_fbTemperPercent / (1 + yGap) +
+                m_executor->m_udTemperPercent / (1 + zGap);
+    }
+}
+
+void SSD::decayHeat() {
+    if (m_executor->m_heatAwarePlacement == false) return;
+
+    m_logicHeatSum *= m_executor->m_heatDecay;
+    for (int logicBlock = 0; logicBlock < m_logicBlock; ++logicBlock) {
+        m_logicHeat[logicBlock] *= m_executor->m_heatDecay;
+    }
+}
+
+bool SSD::isHotLogicBlock(int logicBlock) {
+    if (logicBlock < 0 || logicBlock >= m_logicBlock) return false;
+    return m_logicHeat[logicBlock] - m_executor->m_hotHeatFactor * m_logicHeatSum / m_logicBlock > -LOWESTGAP;
+}
+
+std::list<int>::iterator SSD::pickDissipateBlock() {
+    std::list<int>::iterator bestBlock = m_freeBlock.begin();
+    for (std::list<int>::iterator iterBlock = m_freeBlock.begin();
+         iterBlock != m_freeBlock.end(); ++iterBlock) {
+        double scoreGap = m_dissipateScore[*iterBlock] - m_dissipateScore[*bestBlock];
+        if (scoreGap > LOWESTGAP ||
+                (scoreGap > -LOWESTGAP &&
+                 m_blockData[*bestBlock]->getTemper() - m_blockData[*iterBlock]->getTemper() > LOWESTGAP)) {
+            bestBlock = iterBlock;
+        }
+    }
+    return bestBlock;
+}
+
+std::list<int>::iterator SSD::pickCoolBlock() {
+    std::list<int>::iterator coolBlock = m_freeBlock.begin();
+    for (std::list<int>::iterator iterBlock = m_freeBlock.begin();
+         iterBlock != m_freeBlock.end(); ++iterBlock) {
+        if (m_blockData[*coolBlock]->getTemper() - m_blockData[*iterBlock]->getTemper() > LOWESTGAP) {
+            coolBlock = iterBlock;
+        }
+    }
+    return coolBlock;
+}
+
+int SSD::mergeChain(int logicBlock, int targetBlock, bool refresh) {
+    assert(m_executor);
+
+    std::vector<int> chain;
+    for (int phyBlock = m_entryTable[logicBlock]; phyBlock != -1;
+         phyBlock = m_replaceTable[phyBlock]) {
+        chain.push_back(phyBlock);
+        m_executor->settleErr(phyBlock);
+    }
+
+    // mv data, the OOB real page num tells the page offset in the logic block
+    int numMoved = 0;
+    PageData *srcPage = NULL, *targetPage = NULL;
+    for (std::vector<int>::iterator iterBlock = chain.begin(); iterBlock != chain.end(); ++iterBlock) {
+        for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
+            srcPage = m_blockData[*iterBlock]->getPage(pageIndex);
+
+            chargeFlash(FLASH_READOOB);
+
+            if (srcPage->getValid() == true && srcPage->getRealPageNum() >= 0) {
+                targetPage = m_blockData[targetBlock]->getPage(srcPage->getRealPageNum());
+                if (targetPage->getIsFree() == true) {
+                    targetPage->mvData(srcPage);
+                    if (refresh && targetPage->getErrCount() <= m_executor->deepestDecodeBit()) {
+                        targetPage->correctData();
+                    }
+                    targetPage->setIsFree(false);
+                    targetPage->setRealPageNum(srcPage->getRealPageNum());
+                    targetPage->setValid(true);
+                    ++numMoved;
+
+                    chargeFlash(FLASH_WRITEOOB | FLASH_READPAGE | FLASH_PROGRAM);
+                    m_executor->checkTemper(*iterBlock, m_executor->m_readPageTemper);
+                    m_executor->checkTemper(targetBlock, m_executor->m_writePageTemper);
+                }
+            }
+            srcPage->clearData();
+            srcPage->setIsFree(true);
+            srcPage->setRealPageNum(-1);
+            srcPage->setValid(false);
+        }
+    }
+
+    // erase the old chain
+    for (std::vector<int>::iterator iterBlock = chain.begin(); iterBlock != chain.end(); ++iterBlock) {
+        m_replaceTable[*iterBlock] = -1;
+        m_blockData[*iterBlock]->setIsFree(true);
+        m_blockData[*iterBlock]->addEraseCount(1);
+        m_freeBlock.push_back(*iterBlock);
+
+        chargeFlash(FLASH_WRITEOOB | FLASH_ERASE);
+        m_executor->checkTemper(*iterBlock, m_executor->m_eraseBlockTemper);
+    }
+
+    m_entryTable[logicBlock] = targetBlock;
+    m_replaceTable[targetBlock] = -1;
+    if (numMoved > 0) m_blockData[targetBlock]->markProgram(m_executor->m_simulateTime);
+    return numMoved;
+}
+
+int SSD::relocateBlock(int phyBlock, bool refresh) {
+    return -1;
+}
+
+int SSD::chainLength(int logicBlock) {
+    int length = 0;
+    for (int phyBlock = m_entryTable[logicBlock]; phyBlock != -1;
+         phyBlock = m_replaceTable[phyBlock]) {
+        ++length;
+    }
+    return length;
+}
+
+void SSD::chargeFlash(int opMask) {
+    countFlash(opMask);
+    m_executor->checkTime(flashTime(opMask));
+}
+
+void SSD::countFlash(int opMask) {
+    for (int opIndex = 0; opIndex < NUMFLASHOP; ++opIndex) {
+        if (opMask & (1 << opIndex)) ++m_flashOp[m_opCause][opIndex];
+    }
+}
+
+double SSD::flashTime(int opMask) {
+    double opTime[NUMFLASHOP] = {
+        m_executor->m_readOobTime, m_executor->m_writeOobTime, m_executor->m_readPageTime,
+        m_executor->m_writePageTime, m_executor->m_eraseBlockTime
+    };
+    double time = 0;
+    for (int opIndex = 0; opIndex < NUMFLASHOP; ++opIndex) {
+        if (opMask & (1 << opIndex)) time += opTime[opIndex];
+    }
+    return time;
+}
+
+
 // ======================SSD_1======================
 
-SSD_1::SSD_1() {
+SSD_1::SSD_1() : m_gcLogicBlock(0) {
 
 }
 
@@ -920,7 +1485,11 @@ bool SSD_1::initFreeBlockList(std::string filename) {
         do {
             do {
                 do {
-                    assert(threeDimension2linear(xIter, yIter, zIter, freeBlock) == true);
+                    // kept out of assert, NDEBUG builds need the block number
+                    if (threeDimension2linear(xIter, yIter, zIter, freeBlock) == false) {
+                        std::cerr << "Wrong block position !!!" << std::endl;
+                        return false;
+                    }
                     m_freeBlock.push_back(freeBlock);
                     zIter = (zIter + JUMPGAP) % m_executor->m_levelPerChip;
                 } while(zIter !=0);
@@ -951,9 +1520,9 @@ bool SSD_1::initFreeBlockList(std::string filename) {
     return true;
 }
 
-#include <algorithm>
 const static int NUMCMP = 10;
 int SSD_1::findfree() {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREE);
 
     if (m_freeBlock.size() < m_minimumFreeBlock) return -1;
 
@@ -985,24 +1554,20 @@ int SSD_1::findfree() {
 
 //    m_blockData[freeBlock]->setIsFree(false);
 
-    int freeBlock = m_freeBlock.front();
-    double minimumTemper = m_blockData[freeBlock]->getTemper();
-
-    for (std::list<int>::iterator iterBlock = m_freeBlock.begin();
-         iterBlock != m_freeBlock.end(); ++iterBlock) {
-        if (minimumTemper - m_blockData[*iterBlock]->getTemper() > LOWESTGAP) {
-            freeBlock = *iterBlock;
-            minimumTemper = m_blockData[freeBlock]->getTemper();
-        }
+    // hot logic blocks go where heat leaves the chip fastest
+    if (m_executor->m_heatAwarePlacement && m_freeBlock.empty() == false &&
+            isHotLogicBlock(m_allocLogicBlock)) {
+        std::list<int>::iterator iterBlock = pickDissipateBlock();
+        int freeBlock = *iterBlock;
+        m_freeBlock.erase(iterBlock);
+        m_blockData[freeBlock]->setIsFree(false);
+        ++m_hotAllocCount;
+        return freeBlock;
     }
 
-    for (std::list<int>::iterator iterBlock = m_freeBlock.begin();
-         iterBlock != m_freeBlock.end(); ++iterBlock) {
-        if (freeBlock == *iterBlock) {
-            m_freeBlock.erase(iterBlock);
-            break;
-        }
-    }
+    std::list<int>::iterator iterBlock = pickCoolBlock();
+    int freeBlock = *iterBlock;
+    m_freeBlock.erase(iterBlock);
 
     m_blockData[freeBlock]->setIsFree(false);
     return freeBlock;
@@ -1010,12 +1575,15 @@ int SSD_1::findfree() {
 
 
 bool SSD_1::gc(std::vector<int> &gcChain, int logicNum) {
+    FTL_PROFILE_SCOPE(PROFILE_GC);
+    OpCauseScope opCauseScope(this, OPCAUSE_GC);
 
-    std::cout << "gc" << std::endl;
+    if (m_executor->m_verbose) std::cout << "gc" << std::endl;
+    double beginTime = m_executor->m_simulateTime;
     std::vector<int> chain;
     bool isGcChain = true;
 
-    static int logicBlock = 0;
+    int &logicBlock = m_gcLogicBlock;
     if (gcChain.size() < 3) {
 
         int oldLogicBlock = logicBlock;
@@ -1023,14 +1591,17 @@ bool SSD_1::gc(std::vector<int> &gcChain, int logicNum) {
             for (logicBlock = (logicBlock + 1) % m_logicBlock;
                  logicBlock != oldLogicBlock;
                  logicBlock = (logicBlock + 1) % m_logicBlock) {
-                    std::vector<int> eraseChain;
-                    int phyBlock = m_entryTable[logicBlock];
-                    while (phyBlock != -1) {
-                        eraseChain.push_back(phyBlock);
-                        phyBlock = m_replaceTable[phyBlock];
+                    // count first, only the chosen chain is collected
+                    int chainLength = 0;
+                    for (int phyBlock = m_entryTable[logicBlock]; phyBlock != -1;
+                         phyBlock = m_replaceTable[phyBlock]) {
+                        ++chainLength;
                     }
-                    if (eraseChain.size() == numBlock) {
-                        chain = eraseChain;
+                    if (chainLength == numBlock) {
+                        for (int phyBlock = m_entryTable[logicBlock]; phyBlock != -1;
+                             phyBlock = m_replaceTable[phyBlock]) {
+                            chain.push_back(phyBlock);
+                        }
                         break;
                     }
             }
@@ -1047,6 +1618,7 @@ bool SSD_1::gc(std::vector<int> &gcChain, int logicNum) {
 
     std::vector<int> targetChain, srcChain;
     if (isGcChain == false || gcChain.size() < 3) {
+        ++m_fullMerge;
         int primaryBlock = m_freeBlock.front();
         m_freeBlock.pop_front();
         m_blockData[primaryBlock]->setIsFree(false);
@@ -1056,18 +1628,20 @@ bool SSD_1::gc(std::vector<int> &gcChain, int logicNum) {
 
     } else { // gcChain.size() == 3
        int bufferBlock = gcChain[2], numInvalid = 0;
-       for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+       for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
            if (m_blockData[bufferBlock]->getPage(pageIndex)->getIsFree() == false &&
                    m_blockData[bufferBlock]->getPage(pageIndex)->getValid() == false) ++numInvalid;
        }
        // transfer buffer to primary
-       if (numInvalid <= BlockData::m_pagePerBlock - numInvalid) {
+       if (numInvalid <= m_dataContext.m_pagePerBlock - numInvalid) {
+           ++m_partialMerge;
            targetChain.push_back(bufferBlock);
            gcChain.pop_back();
            srcChain = gcChain;
            gcChain.clear();
            gcChain = targetChain;
        } else { // not transfer
+           ++m_fullMerge;
            int primaryBlock = m_freeBlock.front();
            m_freeBlock.pop_front();
            m_blockData[primaryBlock]->setIsFree(false);
@@ -1090,15 +1664,18 @@ bool SSD_1::gc(std::vector<int> &gcChain, int logicNum) {
         m_blockData[*iterBlock]->addEraseCount(1);
         m_freeBlock.push_back(*iterBlock);
 
-        m_executor->checkTime(m_executor->m_eraseBlockTime +
-                                                m_executor->m_writeOobTime);
+        chargeFlash(FLASH_WRITEOOB | FLASH_ERASE);
         m_executor->checkTemper(*iterBlock, m_executor->m_eraseBlockTemper);
     }
     m_replaceTable[targetChain.back()] = -1;
+    m_blockData[targetChain.back()]->markProgram(m_executor->m_simulateTime);
+    for (std::vector<int>::iterator iterBlock = srcChain.begin(); iterBlock != srcChain.end(); ++iterBlock) {
+        m_executor->settleErr(*iterBlock);
+    }
 
     // mv data
     PageData *srcPage = NULL, *targetPage = NULL;
-    for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+    for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
         targetPage = m_blockData[targetChain.back()]->getPage(pageIndex);
         for (std::vector<int>::iterator iterSrcBlock = srcChain.begin(); iterSrcBlock !=srcChain.end(); ++iterSrcBlock) {
                 srcPage = m_blockData[*iterSrcBlock]->getPage(pageIndex);
@@ -1109,10 +1686,9 @@ bool SSD_1::gc(std::vector<int> &gcChain, int logicNum) {
                     targetPage->setIsFree(false);
                     targetPage->setRealPageNum(srcPage->getRealPageNum());
                     targetPage->setValid(true);
+                    ++m_gcCopyPage;
 
-                    m_executor->checkTime(m_executor->m_writeOobTime +
-                                                            m_executor->m_readPageTime +
-                                                            m_executor->m_writePageTime);
+                    chargeFlash(FLASH_WRITEOOB | FLASH_READPAGE | FLASH_PROGRAM);
                     m_executor->checkTemper(targetChain.back(), m_executor->m_writePageTemper);
                     m_executor->checkTemper(*iterSrcBlock, m_executor->m_readPageTemper);
                 } else {
@@ -1123,11 +1699,12 @@ bool SSD_1::gc(std::vector<int> &gcChain, int logicNum) {
                 srcPage->setRealPageNum(-1);
                 srcPage->setValid(false);
 
-                m_executor->checkTime(m_executor->m_writeOobTime +
-                                                        m_executor->m_readOobTime);
+                chargeFlash(FLASH_READOOB | FLASH_WRITEOOB);
         }
     }
 
+    m_gcTime += m_executor->m_simulateTime - beginTime;
+    ++m_gcCount;
     return isGcChain;
 
 }
@@ -1140,14 +1717,14 @@ bool SSD_1::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
         return false;
     }
 
-    int logicBlock = logicNum / m_executor->m_pagePerBlock;
-    phyPage = logicNum % m_executor->m_pagePerBlock;
+    int logicBlock = logicBlockOf(logicNum);
+    phyPage = logicPageOf(logicNum);
 
     // 0, primary block, entryTable
     int primaryBlock = m_entryTable[logicBlock];
     if (primaryBlock == -1) return false;
 
-    m_executor->checkTime(m_executor->m_readOobTime);
+    chargeFlash(FLASH_READOOB);
 
     if (m_blockData[primaryBlock]->getPage(phyPage)->getValid() == true) {
         phyBlock = primaryBlock;
@@ -1158,9 +1735,9 @@ bool SSD_1::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
     int replaceBlock = m_replaceTable[primaryBlock];
     if (replaceBlock == -1) return false;
 
-    for (int pageIndex = BlockData::m_pagePerBlock - 1; pageIndex >= 0; --pageIndex) {
+    for (int pageIndex = m_dataContext.m_pagePerBlock - 1; pageIndex >= 0; --pageIndex) {
 
-        m_executor->checkTime(m_executor->m_readOobTime);
+        chargeFlash(FLASH_READOOB);
 
         if (m_blockData[replaceBlock]->getPage(pageIndex)->getValid() == true &&
                 m_blockData[replaceBlock]->getPage(pageIndex)->getRealPageNum() == phyPage) {
@@ -1174,7 +1751,7 @@ bool SSD_1::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
     int bufferBlock = m_replaceTable[replaceBlock];
     if (bufferBlock == -1) return false;
 
-    m_executor->checkTime(m_executor->m_readOobTime);
+    chargeFlash(FLASH_READOOB);
 
     if (m_blockData[bufferBlock]->getPage(phyPage)->getValid() == true) {
         phyBlock = bufferBlock;
@@ -1184,10 +1761,11 @@ bool SSD_1::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
 }
 
 bool SSD_1::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREEPAGE);
     assert(m_executor);
 
-    int logicBlock = logicNum / BlockData::m_pagePerBlock,
-            logicPage = logicNum % BlockData::m_pagePerBlock;
+    int logicBlock = logicBlockOf(logicNum),
+            logicPage = logicPageOf(logicNum);
 
     std::vector<int> gcChain;
     PageData *pageData = NULL;
@@ -1207,14 +1785,14 @@ bool SSD_1::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
     gcChain.push_back(primaryBlock);
     pageData = m_blockData[primaryBlock]->getPage(logicPage);
 
-    m_executor->checkTime(m_executor->m_readOobTime);
+    chargeFlash(FLASH_READOOB);
 
     if (pageData->getIsFree() == true) {
         phyBlock = primaryBlock;
         phyPage = logicPage;
         return true;
     }
-    m_executor->checkTime(m_executor->m_writeOobTime);
+    chargeFlash(FLASH_WRITEOOB);
     pageData->setIsFree(false);
     pageData->setRealPageNum(-1);
     pageData->setValid(false);
@@ -1232,17 +1810,17 @@ bool SSD_1::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
         m_replaceTable[replaceBlock] = -1;
     }
     gcChain.push_back(replaceBlock);
-    for (int pageIndex = 0; pageIndex < BlockData::m_pagePerBlock; ++pageIndex) {
+    for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
         pageData = m_blockData[replaceBlock]->getPage(pageIndex);
 
-        m_executor->checkTime(m_executor->m_readOobTime);
+        chargeFlash(FLASH_READOOB);
 
         if (pageData->getRealPageNum() == logicPage && pageData->getValid() == true) {
             pageData->setIsFree(false);
             pageData->setValid(false);
             pageData->setRealPageNum(-1);
 
-            m_executor->checkTime(m_executor->m_writeOobTime);
+            chargeFlash(FLASH_WRITEOOB);
         }
         if (pageData->getIsFree() == true) {
             phyBlock = replaceBlock;
@@ -1279,7 +1857,7 @@ bool SSD_1::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
     pageData->setRealPageNum(-1);
     pageData->setValid(false);
 
-    m_executor->checkTime(m_executor->m_writeOobTime);
+    chargeFlash(FLASH_WRITEOOB);
 
     gc(gcChain, logicPage);
     primaryBlock = gcChain.back();
@@ -1303,6 +1881,8 @@ SSD_2::~SSD_2() {
 bool SSD_2::initFreeBlockList(std::string filename) {
     assert(m_executor);
 
+    m_generator.seed(static_cast<std::default_random_engine::result_type>(m_executor->m_randomSeed));
+
     if (m_executor->m_dataFromFile == false) {
         for (int index = 0; index < m_physicBlock; ++index) {
             m_freeBlock.push_back(index);
@@ -1329,13 +1909,13 @@ bool SSD_2::initFreeBlockList(std::string filename) {
 }
 
 int SSD_2::findfree() {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREE);
 
     if (m_freeBlock.size() < m_minimumFreeBlock) return -1;
 
-    std::default_random_engine generator(time(nullptr));
     std::uniform_int_distribution<int> distribution(0, m_freeBlock.size()-1);
 
-    int index = distribution(generator);
+    int index = distribution(m_generator);
 
     std::list<int>::iterator iterFreeBlock = m_freeBlock.begin();
     int freeBlock = 0;
@@ -1347,61 +1927,695 @@ int SSD_2::findfree() {
 }
 
 
-// ====================Executor=========================
+// ====================SSD_3=========================
+SSD_3::SSD_3() {
+    for (int stream = 0; stream < NUMSTREAM; ++stream) {
+        m_activeBlock[stream] = -1;
+        m_activePage[stream] = 0;
+    }
+}
 
-Executor::Executor() : m_ssd(NULL) {
+SSD_3::~SSD_3() {
+}
 
-    // structure of SSD
-    m_bytePerPage =
-            m_pagePerBlock =
-            m_blockPerLine =
-            m_linePerLevel =
-            m_levelPerChip =
-            m_minimumFreeBlock = 0;
+bool SSD_3::initFreeBlockList(std::string filename) {
+    assert(m_executor);
 
-    m_logicBlock =
-        m_physicBlock = 0;
+    // the page map lives in memory only, a run starts from an empty SSD
+    if (m_executor->m_dataFromFile) {
+        std::cerr << "Page-mapped FTL ignores the saved state, starts empty" << std::endl;
+    }
+    m_pageMap.assign(static_cast<size_t>(m_logicBlock) * m_dataContext.m_pagePerBlock, -1);
+    m_pageOwner.assign(static_cast<size_t>(m_physicBlock) * m_dataContext.m_pagePerBlock, -1);
+    m_validCount.assign(m_physicBlock, 0);
 
-    m_isRealData =
-            m_dataFromFile = false;
+    m_freeBlock.clear();
+    for (int index = 0; index < m_physicBlock; ++index) {
+        m_blockData[index]->setIsFree(true);
+        m_freeBlock.push_back(index);
+    }
+    return true;
+}
 
-    // time variation
-    m_readOobTime =
-            m_writeOobTime =
-            m_readPageTime =
-            m_writePageTime =
-            m_eraseBlockTime = 0;
+int SSD_3::findfree() {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREE);
+    if (m_freeBlock.empty()) return -1;
 
-    // temperature dissipation percentage
-    m_lrTemperPercent =
-            m_fbTemperPercent =
-            m_udTemperPercent = 0;
+    std::list<int>::iterator iterBlock = m_freeBlock.begin();
+    if (m_executor->m_heatAwarePlacement && isHotLogicBlock(m_allocLogicBlock)) {
+        iterBlock = pickDissipateBlock();
+        ++m_hotAllocCount;
+    }
+    int freeBlock = *iterBlock;
+    m_freeBlock.erase(iterBlock);
+    m_blockData[freeBlock]->setIsFree(false);
+    return freeBlock;
+}
 
-    // temperature raise
-    m_readPageTemper =
-            m_writePageTemper =
-            m_eraseBlockTemper = 0;
+bool SSD_3::nextPage(int stream, int &phyBlock, int &phyPage) {
+    if (m_activeBlock[stream] == -1 || m_activePage[stream] == m_dataContext.m_pagePerBlock) {
+        int freeBlock = -1;
+        if (stream == STREAM_HOST) {
+            std::vector<int> gcChain;
+            while (m_freeBlock.size() <= m_minimumFreeBlock) {
+                if (gc(gcChain, -1) == false) break;
+            }
+            freeBlock = findfree();
+        } else if (m_freeBlock.empty() == false) {
+            // relocated data goes cool
+            std::list<int>::iterator iterBlock = pickCoolBlock();
+            freeBlock = *iterBlock;
+            m_freeBlock.erase(iterBlock);
+            m_blockData[freeBlock]->setIsFree(false);
+        }
+        if (freeBlock == -1) return false;
 
-    // time interval
-    m_scanTemperInterval =
-            m_dissTemperInterval =
-            m_createErrInterval =
-            m_calErrInterval = 0;
+        m_activeBlock[stream] = freeBlock;
+        m_activePage[stream] = 0;
+    }
 
-    // time ticker
-    m_dissipateTemperTime =
-            m_statisticTemperTime =
-            m_injectErrTime =
-            m_statisticErrTime = 0;
+    phyBlock = m_activeBlock[stream];
+    phyPage = m_activePage[stream]++;
+    return true;
 }
 
-Executor::~Executor() {
-    m_ssd = NULL;
+int SSD_3::pickVictim() {
+    int victim = -1;
+    for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
+        if (m_blockData[blockIndex]->getIsFree()) continue;
+        if (blockIndex == m_activeBlock[STREAM_HOST] || blockIndex == m_activeBlock[STREAM_GC]) continue;
+        if (victim == -1 || m_validCount[blockIndex] < m_validCount[victim]) victim = blockIndex;
+    }
+    return victim;
 }
 
+bool SSD_3::gc(std::vector<int> &gcChain, int pageNum) {
+    FTL_PROFILE_SCOPE(PROFILE_GC);
+    OpCauseScope opCauseScope(this, OPCAUSE_GC);
+    int victim = pickVictim();
+    // a full victim frees nothing
+    if (victim == -1 || m_validCount[victim] == m_dataContext.m_pagePerBlock) return false;
+
+    double beginTime = m_executor->m_simulateTime;
+    int numMoved = relocate(victim, false);
+    if (numMoved < 0) return false;
+    m_gcCopyPage += numMoved;
+    m_gcTime += m_executor->m_simulateTime - beginTime;
+    ++m_gcCount;
+    return true;
+}
 
+int SSD_3::relocate(int phyBlock, bool refresh) {
+    int pagePerBlock = m_dataContext.m_pagePerBlock,
+            freePage = static_cast<int>(m_freeBlock.size()) * pagePerBlock;
+    if (m_activeBlock[STREAM_GC] != -1) freePage += pagePerBlock - m_activePage[STREAM_GC];
+    if (freePage < m_validCount[phyBlock]) return -1;
 
-bool Executor::readConfigFile(std::string configFileName) {
+    m_executor->settleErr(phyBlock);
+
+    int numMoved = 0, targetBlock = -1, targetPage = -1;
+    PageData *srcPage = NULL, *targetData = NULL;
+    for (int pageIndex = 0; pageIndex < pagePerBlock; ++pageIndex) {
+        int srcNum = phyBlock * pagePerBlock + pageIndex;
+        srcPage = m_blockData[phyBlock]->getPage(pageIndex);
+
+        chargeFlash(FLASH_READOOB);
+
+        if (srcPage->getValid() == true && m_pageOwner[srcNum] >= 0) {
+            nextPage(STREAM_GC, targetBlock, targetPage);
+            targetData = m_blockData[targetBlock]->getPage(targetPage);
+            targetData->mvData(srcPage);
+            if (refresh && targetData->getErrCount() <= m_executor->deepestDecodeBit()) {
+                targetData->correctData();
+            }
+            targetData->setIsFree(false);
+            targetData->setRealPageNum(srcPage->getRealPageNum());
+            targetData->setValid(true);
+            m_blockData[targetBlock]->markProgram(m_executor->m_simulateTime);
+
+            int logicNum = m_pageOwner[srcNum],
+                    targetNum = targetBlock * pagePerBlock + targetPage;
+            m_pageMap[logicNum] = targetNum;
+            m_pageOwner[targetNum] = logicNum;
+            ++m_validCount[targetBlock];
+            ++numMoved;
+
+            chargeFlash(FLASH_WRITEOOB | FLASH_READPAGE | FLASH_PROGRAM);
+            m_executor->checkTemper(phyBlock, m_executor->m_readPageTemper);
+            m_executor->checkTemper(targetBlock, m_executor->m_writePageTemper);
+        }
+        m_pageOwner[srcNum] = -1;
+        srcPage->clearData();
+        srcPage->setIsFree(true);
+        srcPage->setRealPageNum(-1);
+        srcPage->setValid(false);
+    }
+
+    // erase the victim
+    m_validCount[phyBlock] = 0;
+    m_blockData[phyBlock]->setIsFree(true);
+    m_blockData[phyBlock]->addEraseCount(1);
+    m_freeBlock.push_back(phyBlock);
+
+    chargeFlash(FLASH_WRITEOOB | FLASH_ERASE);
+    m_executor->checkTemper(phyBlock, m_executor->m_eraseBlockTemper);
+    return numMoved;
+}
+
+int SSD_3::relocateBlock(int phyBlock, bool refresh) {
+    assert(phyBlock >= 0 && phyBlock < m_physicBlock);
+
+    if (m_blockData[phyBlock]->getIsFree() || m_validCount[phyBlock] == 0) return 0;
+    if (phyBlock == m_activeBlock[STREAM_HOST] || phyBlock == m_activeBlock[STREAM_GC]) return 0;
+
+    int numMoved = relocate(phyBlock, refresh);
+    return numMoved < 0 ? 0 : numMoved;
+}
+
+int SSD_3::chainLength(int logicBlock) {
+    int pagePerBlock = m_dataContext.m_pagePerBlock;
+    std::vector<int> blockList;
+    for (int pageIndex = 0; pageIndex < pagePerBlock; ++pageIndex) {
+        int phyPage = m_pageMap[logicBlock * pagePerBlock + pageIndex];
+        if (phyPage != -1) blockList.push_back(phyPage / pagePerBlock);
+    }
+    std::sort(blockList.begin(), blockList.end());
+    return std::unique(blockList.begin(), blockList.end()) - blockList.begin();
+}
+
+bool SSD_3::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
+    assert(m_executor);
+
+    if (logicNum < 0 || logicNum >= m_pageMap.size()) {
+        std::cerr << "the LogicNum is illegal !!!" << std::endl;
+        return false;
+    }
+
+    // the map is held in controller memory, no OOB lookup
+    int phyNum = m_pageMap[logicNum];
+    if (phyNum == -1) return false;
+
+    phyBlock = phyNum / m_dataContext.m_pagePerBlock;
+    phyPage = phyNum % m_dataContext.m_pagePerBlock;
+    return true;
+}
+
+bool SSD_3::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREEPAGE);
+    assert(m_executor);
+
+    // the new page first, a failed write keeps the old copy mapped;
+    // gc in nextPage may move the old copy, so it is looked up after
+    if (nextPage(STREAM_HOST, phyBlock, phyPage) == false) return false;
+
+    int oldNum = m_pageMap[logicNum];
+    if (oldNum != -1) {
+        int oldBlock = oldNum / m_dataContext.m_pagePerBlock;
+        m_blockData[oldBlock]->getPage(oldNum % m_dataContext.m_pagePerBlock)->setValid(false);
+        --m_validCount[oldBlock];
+        m_pageOwner[oldNum] = -1;
+    }
+
+    int phyNum = phyBlock * m_dataContext.m_pagePerBlock + phyPage;
+    m_pageMap[logicNum] = phyNum;
+    m_pageOwner[phyNum] = logicNum;
+    ++m_validCount[phyBlock];
+    return true;
+}
+
+
+// ====================SSD_4=========================
+SSD_4::SSD_4() : m_seqLogBlock(-1), m_seqLogicBlock(-1), m_seqNextPage(0),
+    m_randNextPage(0), m_maxRandLog(1) {
+}
+
+SSD_4::~SSD_4() {
+}
+
+bool SSD_4::initFreeBlockList(std::string filename) {
+    assert(m_executor);
+
+    // the log maps live in memory only, a run starts from an empty SSD
+    if (m_executor->m_dataFromFile) {
+        std::cerr << "Hybrid log-block FTL ignores the saved state, starts empty" << std::endl;
+    }
+    m_logMap.assign(static_cast<size_t>(m_logicBlock) * m_dataContext.m_pagePerBlock, -1);
+    m_logOwner.assign(static_cast<size_t>(m_physicBlock) * m_dataContext.m_pagePerBlock, -1);
+
+    // data blocks + sequential log + random logs + a merge target fit with the reserve
+    m_maxRandLog = std::max(1, m_physicBlock - m_logicBlock - m_minimumFreeBlock - 1);
+
+    m_freeBlock.clear();
+    for (int index = 0; index < m_physicBlock; ++index) {
+        m_blockData[index]->setIsFree(true);
+        m_freeBlock.push_back(index);
+    }
+    return true;
+}
+
+int SSD_4::findfree() {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREE);
+    if (m_freeBlock.empty()) return -1;
+
+    std::list<int>::iterator iterBlock = m_freeBlock.begin();
+    if (m_executor->m_heatAwarePlacement && isHotLogicBlock(m_allocLogicBlock)) {
+        iterBlock = pickDissipateBlock();
+        ++m_hotAllocCount;
+    }
+    int freeBlock = *iterBlock;
+    m_freeBlock.erase(iterBlock);
+    m_blockData[freeBlock]->setIsFree(false);
+    return freeBlock;
+}
+
+int SSD_4::takeCoolBlock() {
+    assert(m_freeBlock.empty() == false);
+
+    std::list<int>::iterator iterBlock = pickCoolBlock();
+    int freeBlock = *iterBlock;
+    m_freeBlock.erase(iterBlock);
+    m_blockData[freeBlock]->setIsFree(false);
+    return freeBlock;
+}
+
+void SSD_4::movePage(int srcBlock, int srcPage, int targetBlock, int targetPage, bool refresh) {
+    m_executor->settleErr(srcBlock);
+
+    PageData *srcData = m_blockData[srcBlock]->getPage(srcPage),
+            *targetData = m_blockData[targetBlock]->getPage(targetPage);
+    targetData->mvData(srcData);
+    if (refresh && targetData->getErrCount() <= m_executor->deepestDecodeBit()) {
+        targetData->correctData();
+    }
+    targetData->setIsFree(false);
+    targetData->setRealPageNum(targetPage);
+    targetData->setValid(true);
+    srcData->setValid(false);
+    m_logOwner[srcBlock * m_dataContext.m_pagePerBlock + srcPage] = -1;
+
+    chargeFlash(FLASH_READOOB | FLASH_WRITEOOB | FLASH_READPAGE | FLASH_PROGRAM);
+    m_executor->checkTemper(srcBlock, m_executor->m_readPageTemper);
+    m_executor->checkTemper(targetBlock, m_executor->m_writePageTemper);
+}
+
+void SSD_4::eraseBlock(int phyBlock) {
+    for (int pageIndex = 0; pageIndex < m_dataContext.m_pagePerBlock; ++pageIndex) {
+        PageData *pageData = m_blockData[phyBlock]->getPage(pageIndex);
+        pageData->clearData();
+        pageData->setIsFree(true);
+        pageData->setRealPageNum(-1);
+        pageData->setValid(false);
+        m_logOwner[phyBlock * m_dataContext.m_pagePerBlock + pageIndex] = -1;
+    }
+    m_replaceTable[phyBlock] = -1;
+    m_blockData[phyBlock]->setIsFree(true);
+    m_blockData[phyBlock]->addEraseCount(1);
+    m_freeBlock.push_back(phyBlock);
+
+    chargeFlash(FLASH_WRITEOOB | FLASH_ERASE);
+    m_executor->checkTemper(phyBlock, m_executor->m_eraseBlockTemper);
+}
+
+void SSD_4::closeSeqLog() {
+    if (m_seqLogBlock == -1) return;
+    OpCauseScope opCauseScope(this, OPCAUSE_GC);
+
+    double beginTime = m_executor->m_simulateTime;
+    int logicBlock = m_seqLogicBlock, seqBlock = m_seqLogBlock,
+            pagePerBlock = m_dataContext.m_pagePerBlock,
+            dataBlock = m_entryTable[logicBlock];
+    m_seqLogBlock = -1;
+    m_seqLogicBlock = -1;
+
+    // the written pages sit at their offsets already
+    for (int pageIndex = 0; pageIndex < m_seqNextPage; ++pageIndex) {
+        int logicNum = logicBlock * pagePerBlock + pageIndex;
+        if (m_logMap[logicNum] == seqBlock * pagePerBlock + pageIndex) m_logMap[logicNum] = -1;
+        m_logOwner[seqBlock * pagePerBlock + pageIndex] = -1;
+    }
+
+    if (m_seqNextPage == pagePerBlock) {
+        ++m_switchMerge;
+    } else {
+        // copy the missing tail from the random logs | the old data block
+        ++m_partialMerge;
+        for (int pageIndex = m_seqNextPage; pageIndex < pagePerBlock; ++pageIndex) {
+            int logicNum = logicBlock * pagePerBlock + pageIndex, logPage = m_logMap[logicNum];
+            chargeFlash(FLASH_READOOB);
+            if (logPage != -1) {
+                movePage(logPage / pagePerBlock, logPage % pagePerBlock, seqBlock, pageIndex);
+                m_logMap[logicNum] = -1;
+                ++m_gcCopyPage;
+            } else if (dataBlock != -1 && m_blockData[dataBlock]->getPage(pageIndex)->getValid()) {
+                movePage(dataBlock, pageIndex, seqBlock, pageIndex);
+                ++m_gcCopyPage;
+            }
+        }
+        m_blockData[seqBlock]->markProgram(m_executor->m_simulateTime);
+    }
+
+    // every page of the old data block is superseded now
+    if (dataBlock != -1) eraseBlock(dataBlock);
+    m_entryTable[logicBlock] = seqBlock;
+    m_replaceTable[seqBlock] = -1;
+    m_gcTime += m_executor->m_simulateTime - beginTime;
+    ++m_gcCount;
+}
+
+int SSD_4::fullMerge(int logicBlock, bool refresh) {
+    ++m_fullMerge;
+
+    int pagePerBlock = m_dataContext.m_pagePerBlock,
+            dataBlock = m_entryTable[logicBlock],
+            targetBlock = takeCoolBlock(),
+            numMoved = 0;
+    bool isSeqOwner = (logicBlock == m_seqLogicBlock);
+
+    for (int pageIndex = 0; pageIndex < pagePerBlock; ++pageIndex) {
+        int logicNum = logicBlock * pagePerBlock + pageIndex, logPage = m_logMap[logicNum];
+        chargeFlash(FLASH_READOOB);
+        if (logPage != -1) {
+            movePage(logPage / pagePerBlock, logPage % pagePerBlock, targetBlock, pageIndex, refresh);
+            m_logMap[logicNum] = -1;
+            ++numMoved;
+        } else if (dataBlock != -1 && m_blockData[dataBlock]->getPage(pageIndex)->getValid()) {
+            movePage(dataBlock, pageIndex, targetBlock, pageIndex, refresh);
+            ++numMoved;
+        }
+    }
+    m_blockData[targetBlock]->markProgram(m_executor->m_simulateTime);
+
+    if (dataBlock != -1) eraseBlock(dataBlock);
+    // the sequential log of this logic block holds nothing valid anymore
+    if (isSeqOwner) {
+        eraseBlock(m_seqLogBlock);
+        m_seqLogBlock = -1;
+        m_seqLogicBlock = -1;
+    }
+    m_entryTable[logicBlock] = targetBlock;
+    m_replaceTable[targetBlock] = -1;
+    return numMoved;
+}
+
+int SSD_4::reclaimRandLog(int victim, bool refresh) {
+    int pagePerBlock = m_dataContext.m_pagePerBlock;
+    std::vector<int> logicBlockList;
+    for (int pageIndex = 0; pageIndex < pagePerBlock; ++pageIndex) {
+        int logicNum = m_logOwner[victim * pagePerBlock + pageIndex];
+        chargeFlash(FLASH_READOOB);
+        if (logicNum != -1) logicBlockList.push_back(logicBlockOf(logicNum));
+    }
+    std::sort(logicBlockList.begin(), logicBlockList.end());
+    logicBlockList.erase(std::unique(logicBlockList.begin(), logicBlockList.end()), logicBlockList.end());
+
+    int numMoved = 0;
+    for (int index = 0; index < logicBlockList.size(); ++index) {
+        numMoved += fullMerge(logicBlockList[index], refresh);
+    }
+    eraseBlock(victim);
+    return numMoved;
+}
+
+bool SSD_4::gc(std::vector<int> &gcChain, int pageNum) {
+    FTL_PROFILE_SCOPE(PROFILE_GC);
+    OpCauseScope opCauseScope(this, OPCAUSE_GC);
+    if (m_randLog.empty()) return false;
+
+    double beginTime = m_executor->m_simulateTime;
+    int victim = m_randLog.front();
+    m_randLog.pop_front();
+    if (m_randLog.empty()) m_randNextPage = 0;
+
+    m_gcCopyPage += reclaimRandLog(victim, false);
+    m_gcTime += m_executor->m_simulateTime - beginTime;
+    ++m_gcCount;
+    return true;
+}
+
+bool SSD_4::logic2physic(int logicNum, int &phyBlock, int &phyPage) {
+    assert(m_executor);
+
+    if (logicNum < 0 || logicNum >= m_logMap.size()) {
+        std::cerr << "the LogicNum is illegal !!!" << std::endl;
+        return false;
+    }
+
+    // block map & log page map are held in controller memory
+    int logPage = m_logMap[logicNum];
+    if (logPage != -1) {
+        phyBlock = logPage / m_dataContext.m_pagePerBlock;
+        phyPage = logPage % m_dataContext.m_pagePerBlock;
+        return true;
+    }
+
+    int dataBlock = m_entryTable[logicBlockOf(logicNum)];
+    phyPage = logicPageOf(logicNum);
+    if (dataBlock == -1) return false;
+
+    chargeFlash(FLASH_READOOB);
+    if (m_blockData[dataBlock]->getPage(phyPage)->getValid() == false) return false;
+    phyBlock = dataBlock;
+    return true;
+}
+
+bool SSD_4::findfreePage(int logicNum, int &phyBlock, int &phyPage) {
+    FTL_PROFILE_SCOPE(PROFILE_FINDFREEPAGE);
+    assert(m_executor);
+
+    int pagePerBlock = m_dataContext.m_pagePerBlock,
+            logicBlock = logicBlockOf(logicNum),
+            logicPage = logicPageOf(logicNum);
+
+    // 1, a full sequential log is switched in
+    if (m_seqLogBlock != -1 && m_seqNextPage == pagePerBlock) closeSeqLog();
+
+    // 2, sequential log: appended in order, opened by a write at offset 0
+    bool isSeqAppend = (m_seqLogBlock != -1 && m_seqLogicBlock == logicBlock &&
+                        m_seqNextPage == logicPage);
+    if (isSeqAppend == false && logicPage == 0) {
+        closeSeqLog();
+        m_seqLogBlock = findfree();
+        if (m_seqLogBlock == -1) return false;
+        m_seqLogicBlock = logicBlock;
+        m_seqNextPage = 0;
+        isSeqAppend = true;
+    }
+    if (isSeqAppend) {
+        phyBlock = m_seqLogBlock;
+        phyPage = m_seqNextPage++;
+    } else {
+        // 3, random log: a new block once the newest is full, the oldest reclaimed over the limit
+        if (m_randLog.empty() || m_randNextPage == pagePerBlock) {
+            std::vector<int> gcChain;
+            if (m_randLog.size() >= m_maxRandLog) gc(gcChain, -1);
+
+            int freeBlock = findfree();
+            if (freeBlock == -1) return false;
+            m_randLog.push_back(freeBlock);
+            m_randNextPage = 0;
+        }
+        phyBlock = m_randLog.back();
+        phyPage = m_randNextPage++;
+    }
+
+    // 4, the old copy turns invalid only once the new page is taken, where
+    // the merges above left it
+    int logPage = m_logMap[logicNum];
+    if (logPage != -1) {
+        m_blockData[logPage / pagePerBlock]->getPage(logPage % pagePerBlock)->setValid(false);
+        m_logOwner[logPage] = -1;
+    } else if (m_entryTable[logicBlock] != -1) {
+        m_blockData[m_entryTable[logicBlock]]->getPage(logicPage)->setValid(false);
+    }
+
+    m_logMap[logicNum] = phyBlock * pagePerBlock + phyPage;
+    m_logOwner[phyBlock * pagePerBlock + phyPage] = logicNum;
+    return true;
+}
+
+int SSD_4::relocateBlock(int phyBlock, bool refresh) {
+    assert(phyBlock >= 0 && phyBlock < m_physicBlock);
+    if (m_blockData[phyBlock]->getIsFree()) return 0;
+
+    if (phyBlock == m_seqLogBlock) return fullMerge(m_seqLogicBlock, refresh);
+
+    std::deque<int>::iterator iterLog = std::find(m_randLog.begin(), m_randLog.end(), phyBlock);
+    if (iterLog == m_randLog.end()) return 0;
+    // the writes go on in a new random log when the newest one leaves
+    bool isNewest = (phyBlock == m_randLog.back());
+    m_randLog.erase(iterLog);
+    if (m_randLog.empty()) m_randNextPage = 0;
+    else if (isNewest) m_randNextPage = m_dataContext.m_pagePerBlock;
+    return reclaimRandLog(phyBlock, refresh);
+}
+
+int SSD_4::chainLength(int logicBlock) {
+    int pagePerBlock = m_dataContext.m_pagePerBlock;
+    std::vector<int> blockList;
+    for (int pageIndex = 0; pageIndex < pagePerBlock; ++pageIndex) {
+        int logPage = m_logMap[logicBlock * pagePerBlock + pageIndex];
+        if (logPage != -1) blockList.push_back(logPage / pagePerBlock);
+    }
+    std::sort(blockList.begin(), blockList.end());
+    int length = std::unique(blockList.begin(), blockList.end()) - blockList.begin();
+    return m_entryTable[logicBlock] != -1 ? length + 1 : length;
+}
+
+
+// ====================createSSD=========================
+SSD *createSSD(const std::string &methodNum) {
+    if (methodNum == std::string("1")) return new SSD_1;
+    if (methodNum == std::string("2")) return new SSD_2;
+    if (methodNum == std::string("3")) return new SSD_3;
+    if (methodNum == std::string("4")) return new SSD_4;
+    return NULL;
+}
+
+
+// ====================Executor=========================
+
+Executor::Executor() : m_ssd(NULL) {
+
+    // structure of SSD
+    m_bytePerPage =
+            m_pagePerBlock =
+            m_blockPerLine =
+            m_linePerLevel =
+            m_levelPerChip =
+            m_minimumFreeBlock = 0;
+
+    m_logicBlock =
+        m_physicBlock = 0;
+
+    m_isRealData =
+            m_dataFromFile = false;
+
+    // time variation
+    m_readOobTime =
+            m_writeOobTime =
+            m_readPageTime =
+            m_writePageTime =
+            m_eraseBlockTime = 0;
+
+    // temperature dissipation percentage
+    m_lrTemperPercent =
+            m_fbTemperPercent =
+            m_udTemperPercent = 0;
+
+    // temperature raise
+    m_readPageTemper =
+            m_writePageTemper =
+            m_eraseBlockTemper = 0;
+
+    // time interval
+    m_scanTemperInterval =
+            m_dissTemperInterval =
+            m_createErrInterval =
+            m_calErrInterval = 0;
+
+    m_eccNumBit = 0;
+
+    m_randomSeed = 0;
+    m_numThread = 1;
+
+    // error rate depends on temperature only until configured
+    m_wearCoef = 0;
+    m_wearScale = 1;
+    m_wearExponent = 1;
+    m_retentionCoef = 0;
+    m_retentionScale = 1;
+    m_lazyErr = false;
+
+    // read path, no decode cost & no soft decode / retry until configured
+    m_hardDecodeTime =
+            m_hardDecodeTemper = 0;
+    m_softEccNumBit = 0;
+    m_softDecodeTime =
+            m_softDecodeTemper = 0;
+
+    m_uncorrectableRead =
+            m_readCount = 0;
+    m_readLatencySum =
+            m_readLatencyMax = 0;
+    m_readLatencyHist.assign(32, 0);
+
+    // dynamic thermal management, disabled until configured
+    m_throttleScope = 0;
+    m_throttleHaltTemper = 0;
+    m_throttleMaxStall = 0;
+
+    m_heatAwarePlacement = false;
+    m_hotHeatFactor = 2;
+    m_heatDecay = 1;
+
+    m_migrateInterval = 0;
+    m_hotspotTemper = 0;
+    m_hotspotRound = 1;
+    m_migrateBudget = 0;
+
+    m_scrubInterval = 0;
+    m_scrubBudget = 0;
+    m_scrubThreshold = 1;
+
+    m_telemetryInterval = 0;
+    m_telemetry = NULL;
+    m_profileRun = NULL;
+
+    m_scrubCursor = 0;
+    m_scrubPageCursor = 0;
+    m_scrubEraseCount = 0;
+    m_scrubWorstErr = 0;
+    m_scrubRun =
+            m_scrubPageRead =
+            m_scrubRefreshChain =
+            m_scrubRefreshPage =
+            m_scrubRefreshErase =
+            m_scrubNearEccPage =
+            m_scrubOverEccPage =
+            m_scrubLostPage = 0;
+    m_scrubBusyTime = 0;
+
+    m_peakTemper = 25;
+    m_migrateChain =
+            m_migratePage =
+            m_migrateErase = 0;
+    m_injectErrCount = 0;
+    m_injectEpoch = 0;
+
+    m_simulateTime = 0;
+    m_throttleEvent =
+            m_throttleStall = 0;
+    m_throttleTime = 0;
+
+    // time ticker
+    m_dissipateTemperTime =
+            m_statisticTemperTime =
+            m_injectErrTime =
+            m_statisticErrTime =
+            m_migrateTime =
+            m_scrubTime =
+            m_telemetryTime = 0;
+    m_migratePending =
+            m_scrubPending =
+            m_telemetryPending = false;
+
+    m_verbose = true;
+    m_barrierDissipate =
+            m_hasGhostPre =
+            m_hasGhostNext = false;
+    m_shotCount = 0;
+    m_requestCount = 0;
+}
+
+Executor::~Executor() {
+    delete m_telemetry;
+    deleteProfileRun(m_profileRun);
+    m_ssd = NULL;
+}
+
+
+
+bool Executor::readConfigFile(std::string configFileName) {
     std::ifstream inStream;
     inStream.open(configFileName.c_str(), std::ios_base::in);
 
@@ -1461,6 +2675,11 @@ bool Executor::readConfigFile(std::string configFileName) {
         inStream >> tmpTemper >> errCount;
         m_temper2numBlockErr[tmpTemper] = errCount;
     }
+    for (std::map<double, int>::iterator iterMap = m_temper2numBlockErr.begin();
+         iterMap != m_temper2numBlockErr.end(); ++iterMap) {
+        m_errTemperStage.push_back(iterMap->first);
+        m_errCountStage.push_back(iterMap->second);
+    }
     inStream >> m_eccNumBit;
 
 
@@ -1485,6 +2704,81 @@ bool Executor::readConfigFile(std::string configFileName) {
             >> m_errorFilename
             >> m_summaryFilename;
 
+    // dynamic thermal management
+    int throttleStage = 0;
+    readOptional(inStream, m_throttleScope);
+    readOptional(inStream, throttleStage);
+    double throttleDelay;
+    for (; throttleStage > 0; --throttleStage) {
+        if (!(inStream >> tmpTemper >> throttleDelay)) break;
+        m_throttleTemper.push_back(tmpTemper);
+        m_throttleDelay.push_back(throttleDelay);
+    }
+    readOptional(inStream, m_throttleHaltTemper);
+    readOptional(inStream, m_throttleMaxStall);
+    if (m_throttleScope == 1) {
+        m_levelMaxTemper.assign(m_levelPerChip, 25);
+    }
+
+    // heat-dissipation-aware placement
+    int heatAwarePlacement = 0;
+    readOptional(inStream, heatAwarePlacement);
+    m_heatAwarePlacement = heatAwarePlacement == 0 ? false : true;
+    readOptional(inStream, m_hotHeatFactor);
+    readOptional(inStream, m_heatDecay);
+
+    // hotspot migration
+    readOptional(inStream, m_migrateInterval);
+    readOptional(inStream, m_hotspotTemper);
+    readOptional(inStream, m_hotspotRound);
+    readOptional(inStream, m_migrateBudget);
+
+    // random seed (0 : defaultSeed) & worker threads
+    readOptional(inStream, m_randomSeed);
+    if (m_randomSeed == 0) m_randomSeed = defaultSeed();
+    readOptional(inStream, m_numThread);
+    if (m_numThread < 1) m_numThread = 1;
+
+    // read path: hard decode, soft decode, read-retry levels
+    readOptional(inStream, m_hardDecodeTime);
+    readOptional(inStream, m_hardDecodeTemper);
+    m_softEccNumBit = m_eccNumBit;
+    readOptional(inStream, m_softEccNumBit);
+    readOptional(inStream, m_softDecodeTime);
+    readOptional(inStream, m_softDecodeTemper);
+    int retryLevel = 0, retryEccNumBit;
+    double retryTime, retryTemper;
+    readOptional(inStream, retryLevel);
+    for (; retryLevel > 0; --retryLevel) {
+        if (!(inStream >> retryEccNumBit >> retryTime >> retryTemper)) break;
+        m_retryEccNumBit.push_back(retryEccNumBit);
+        m_retryTime.push_back(retryTime);
+        m_retryTemper.push_back(retryTemper);
+    }
+    m_decodeLevelCount.assign(2 + m_retryEccNumBit.size(), 0);
+
+    // scrubbing
+    readOptional(inStream, m_scrubInterval);
+    readOptional(inStream, m_scrubBudget);
+    readOptional(inStream, m_scrubThreshold);
+
+    // wear & retention factors of the error rate
+    readOptional(inStream, m_wearCoef);
+    readOptional(inStream, m_wearScale);
+    readOptional(inStream, m_wearExponent);
+    readOptional(inStream, m_retentionCoef);
+    readOptional(inStream, m_retentionScale);
+    if (m_wearScale <= 0) m_wearScale = 1;
+    if (m_retentionScale <= 0) m_retentionScale = 1;
+
+    // lazy error accrual
+    int lazyErr = 0;
+    readOptional(inStream, lazyErr);
+    m_lazyErr = lazyErr == 0 ? false : true;
+
+    // drive state time series
+    readOptional(inStream, m_telemetryInterval);
+
     inStream.close();
     return true;
 }
@@ -1510,48 +2804,98 @@ void Executor::setSSD(SSD *ssd) {
     m_ssd = ssd;
 }
 
+void Executor::setTraceFile(const std::string &traceFile) {
+    m_traceFileNameList.assign(1, traceFile);
+}
+
+static std::string redirectFilename(const std::string &prefix, const std::string &filename,
+                                   bool keepDir) {
+    std::string::size_type slash = filename.find_last_of('/');
+    if (slash == std::string::npos) return prefix + filename;
+    if (keepDir) return filename.substr(0, slash + 1) + prefix + filename.substr(slash + 1);
+    return prefix + filename.substr(slash + 1);
+}
+
+void Executor::redirectOutput(const std::string &prefix, bool keepDir) {
+    m_entryTableFile = redirectFilename(prefix, m_entryTableFile, keepDir);
+    m_replaceTableFile = redirectFilename(prefix, m_replaceTableFile, keepDir);
+    m_dataFilePrefix = redirectFilename(prefix, m_dataFilePrefix, keepDir);
+    m_metaDataFile = redirectFilename(prefix, m_metaDataFile, keepDir);
+    m_freeBlockListFile = redirectFilename(prefix, m_freeBlockListFile, keepDir);
+
+    m_temperShotPrefix = redirectFilename(prefix, m_temperShotPrefix, keepDir);
+    m_errorFilename = redirectFilename(prefix, m_errorFilename, keepDir);
+    m_summaryFilename = redirectFilename(prefix, m_summaryFilename, keepDir);
+}
+
 
 
 bool Executor::beginProcess() {
-    std::ifstream inStream;
+    if (m_profileRun == NULL) m_profileRun = createProfileRun();
+    ProfileRunScope profileRunScope(m_profileRun);
+    TraceReader traceReader;
 
     for (int traceIndex = 0; traceIndex < m_traceFileNameList.size(); ++traceIndex) {
-        inStream.open(m_traceFileNameList[traceIndex].c_str(), std::ios_base::in);
-        if (inStream.is_open() == false) {
+        if (traceReader.open(m_traceFileNameList[traceIndex]) == false) {
             std::cerr << "Fail to open tracefile" << m_traceFileNameList[traceIndex] <<std::endl;
             continue;
         }
-        if (processRequest(inStream) == false) {
+        if (processRequest(traceReader) == false) {
             std::cerr << "Fail to process tracefile " << m_traceFileNameList[traceIndex] << std::endl;
-            inStream.close();
-            exit(1);
+            traceReader.close();
+            return false;
         }
-        inStream.close();
+        traceReader.close();
     }
     return true;
 }
 
 bool Executor::endProcess() {
+    ProfileRunScope profileRunScope(m_profileRun);
+    if (m_lazyErr) settleAllErr();
+
     m_ssd->writeBackTable(m_entryTableFile, "entryTable");
     m_ssd->writeBackTable(m_replaceTableFile, "replaceTable");
     m_ssd->writeBackFreeBlockList(m_freeBlockListFile);
     m_ssd->writeBackMetaData(m_metaDataFile);
-    m_ssd->writeBackBlockData(m_dataFilePrefix);
-    m_ssd->writeBackSummary(m_summaryFilename);
+    bool isOk = m_ssd->writeBackBlockData(m_dataFilePrefix);
+    if (m_telemetryInterval > 0) {
+        sampleTelemetry();
+        if (m_telemetry != NULL) isOk = m_telemetry->close() && isOk;
+    }
+    // the members of a partitioned run leave it to the PartitionExecutor
+    if (m_profileRun != NULL) isOk = writeProfile(m_profileRun, m_summaryFilename + "_profile") && isOk;
+    return m_ssd->writeBackSummary(m_summaryFilename) && isOk;
+}
+
+bool Executor::snapshot(const std::string &prefix) {
+    if (m_lazyErr) settleAllErr();
+
+    m_ssd->writeBackTable(redirectFilename(prefix, m_entryTableFile, false), "entryTable");
+    m_ssd->writeBackTable(redirectFilename(prefix, m_replaceTableFile, false), "replaceTable");
+    m_ssd->writeBackFreeBlockList(redirectFilename(prefix, m_freeBlockListFile, false));
+    m_ssd->writeBackMetaData(redirectFilename(prefix, m_metaDataFile, false));
+    bool isOk = m_ssd->writeBackBlockData(redirectFilename(prefix, m_dataFilePrefix, false));
+    return m_ssd->writeBackSummary(redirectFilename(prefix, m_summaryFilename, false)) && isOk;
 }
 
 
 
 void Executor::checkTime(double time) {
+    FTL_PROFILE_COUNT(PROFILE_CHECKTIME);
     assert(m_ssd);
 
+    m_simulateTime += time;
     m_dissipateTemperTime += time;
     m_statisticTemperTime += time;
     m_injectErrTime += time;
     m_statisticErrTime += time;
+    m_migrateTime += time;
+    m_scrubTime += time;
+    m_telemetryTime += time;
 
     if (m_injectErrTime - m_createErrInterval > LOWESTGAP) {
-        injectErr();
+        if (m_lazyErr == false) injectErr();
         m_injectErrTime = 0;
     }
 
@@ -1560,7 +2904,9 @@ void Executor::checkTime(double time) {
         m_statisticErrTime = 0;
     }
 
-    if (m_dissipateTemperTime - m_dissTemperInterval > LOWESTGAP) {
+    // a partitioned run dissipates at the barrier of the partitions
+    if (m_barrierDissipate == false
+            && m_dissipateTemperTime - m_dissTemperInterval > LOWESTGAP) {
         disspateTemper();
         m_dissipateTemperTime = 0;
     }
@@ -1569,23 +2915,140 @@ void Executor::checkTime(double time) {
         statisticTemper();
         m_statisticTemperTime = 0;
     }
+
+    // background tasks move data, they wait for the end of the request
+    if (m_migrateInterval > 0 && m_migrateTime - m_migrateInterval > LOWESTGAP) {
+        m_migratePending = true;
+        m_migrateTime = 0;
+    }
+    if (m_scrubInterval > 0 && m_scrubTime - m_scrubInterval > LOWESTGAP) {
+        m_scrubPending = true;
+        m_scrubTime = 0;
+    }
+    // so do the samples, the mapping is consistent in between
+    if (m_telemetryInterval > 0 && m_telemetryTime - m_telemetryInterval > LOWESTGAP) {
+        m_telemetryPending = true;
+        m_telemetryTime = 0;
+    }
+}
+
+void Executor::runBackgroundTask() {
+    if (m_migratePending) {
+        m_migratePending = false;
+        migrateHotspot();
+    }
+    if (m_scrubPending) {
+        m_scrubPending = false;
+        double startTime = m_simulateTime;
+        scrub();
+        m_scrubBusyTime += m_simulateTime - startTime;
+    }
+    if (m_telemetryPending) {
+        m_telemetryPending = false;
+        sampleTelemetry();
+    }
 }
 
 void Executor::checkTemper(int blockIndex, double raiseTemper) {
+    accrueErr(blockIndex);
+
     double blockTemper = 0;
     blockTemper = m_ssd->m_blockData[blockIndex]->getTemper();
     blockTemper += raiseTemper;
     m_ssd->m_blockData[blockIndex]->setTemper(blockTemper);
 }
 
+double Executor::throttleTemper(int blockIndex) {
+    if (m_throttleScope == 1) return m_levelMaxTemper[blockIndex / (m_blockPerLine * m_linePerLevel)];
+    return m_ssd->m_blockData[blockIndex]->getTemper();
+}
 
+int Executor::decodeRead(int blockIndex, int errCount) {
+    ++m_readCount;
+    int level = decodePage(blockIndex, errCount);
+    if (level >= 0) ++m_decodeLevelCount[level];
+    else ++m_uncorrectableRead;
+    return level;
+}
 
+int Executor::decodePage(int blockIndex, int errCount) {
+    // 0, hard decision decode
+    checkTime(m_hardDecodeTime);
+    checkTemper(blockIndex, m_hardDecodeTemper);
+    if (errCount <= m_eccNumBit) return 0;
+
+    // 1, soft decision decode, extra sensing of the page
+    if (m_softEccNumBit > m_eccNumBit) {
+        checkTime(m_softDecodeTime);
+        checkTemper(blockIndex, m_softDecodeTemper);
+        if (errCount <= m_softEccNumBit) return 1;
+    }
 
-void Executor::disspateTemper() {
+    // 2, read retry with shifted read voltage
+    for (int retryIndex = 0; retryIndex < m_retryEccNumBit.size(); ++retryIndex) {
+        checkTime(m_readPageTime + m_retryTime[retryIndex]);
+        m_ssd->countFlash(FLASH_READPAGE);
+        checkTemper(blockIndex, m_readPageTemper + m_retryTemper[retryIndex]);
+        if (errCount <= m_retryEccNumBit[retryIndex]) return 2 + retryIndex;
+    }
+    return -1;
+}
+
+int Executor::deepestDecodeBit() {
+    int numBit = std::max(m_eccNumBit, m_softEccNumBit);
+    for (int retryIndex = 0; retryIndex < m_retryEccNumBit.size(); ++retryIndex) {
+        numBit = std::max(numBit, m_retryEccNumBit[retryIndex]);
+    }
+    return numBit;
+}
+
+void Executor::recordReadLatency(double latency) {
+    m_readLatencySum += latency;
+    if (latency > m_readLatencyMax) m_readLatencyMax = latency;
+
+    int bucket = 0;
+    for (double bound = m_readPageTime * 2; latency - bound > LOWESTGAP &&
+         bucket < m_readLatencyHist.size() - 1; bound *= 2) {
+        ++bucket;
+    }
+    ++m_readLatencyHist[bucket];
+}
+
+void Executor::throttle(int blockIndex) {
+    if (m_throttleTemper.empty() && m_throttleMaxStall <= 0) return;
+
+    double blockTemper = throttleTemper(blockIndex);
+
+    // reduced-rate operation, the highest stage reached decides the delay
+    int stage = -1;
+    for (int stageIndex = 0; stageIndex < m_throttleTemper.size(); ++stageIndex) {
+        if (blockTemper - m_throttleTemper[stageIndex] > -LOWESTGAP) stage = stageIndex;
+    }
+    if (stage != -1) {
+        ++m_throttleEvent;
+        m_throttleTime += m_throttleDelay[stage];
+        checkTime(m_throttleDelay[stage]);
+    }
 
-    int midBlockPos = m_blockPerLine / 2,
-            midLinePos = m_linePerLevel / 2,
-            midLevelPos = m_levelPerChip / 2;
+    // halt the access until the block cools down
+    for (int stall = 0; stall < m_throttleMaxStall &&
+         throttleTemper(blockIndex) - m_throttleHaltTemper > -LOWESTGAP; ++stall) {
+        if (stall == 0 && stage == -1) ++m_throttleEvent;
+        ++m_throttleStall;
+        m_throttleTime += m_dissTemperInterval;
+        checkTime(m_dissTemperInterval);
+    }
+}
+
+
+
+
+template <class Geometry>
+void Executor::dissipateKernel(const Geometry &geometry) {
+
+    int midBlockPos = geometry.blockPerLine() / 2,
+            midLinePos = geometry.linePerLevel() / 2,
+            midLevelPos = geometry.levelPerChip() / 2;
 
     int preIndex = 0, nextIndex = 0,
             phyBlock = 0, neighborPre = 0, neighborNext = 0;
@@ -1593,41 +3056,41 @@ void Executor::disspateTemper() {
     // level-exchange heat
     for (preIndex = midLevelPos - 1, nextIndex = midLevelPos;
          preIndex >= 0 ; --preIndex, ++nextIndex) {
-        for (int lineIndex = 0; lineIndex < m_linePerLevel; ++lineIndex) {
-            for (int blockIndex = 0; blockIndex < m_blockPerLine; ++blockIndex) {
+        for (int lineIndex = 0; lineIndex < geometry.linePerLevel(); ++lineIndex) {
+            for (int blockIndex = 0; blockIndex < geometry.blockPerLine(); ++blockIndex) {
                 // up partial
-                if (preIndex > 0) m_ssd->threeDimension2linear(blockIndex, lineIndex, preIndex -1, neighborPre);
-                else neighborPre = -1;
-                m_ssd->threeDimension2linear(blockIndex, lineIndex, preIndex, phyBlock);
-                m_ssd->threeDimension2linear(blockIndex, lineIndex, preIndex + 1, neighborNext);
+                if (preIndex > 0) neighborPre = geometry.linear(blockIndex, lineIndex, preIndex -1);
+                else neighborPre = ghostBlock(blockIndex, lineIndex, false);
+                phyBlock = geometry.linear(blockIndex, lineIndex, preIndex);
+                neighborNext = geometry.linear(blockIndex, lineIndex, preIndex + 1);
                 this->releaseTemper(neighborPre, phyBlock, neighborNext, m_udTemperPercent);
 
                 // down partial
-                m_ssd->threeDimension2linear(blockIndex, lineIndex, nextIndex - 1, neighborPre);
-                m_ssd->threeDimension2linear(blockIndex, lineIndex, nextIndex, phyBlock);
-                if (nextIndex < m_levelPerChip - 1) m_ssd->threeDimension2linear(blockIndex, lineIndex, nextIndex + 1, neighborNext);
-                else neighborNext = -1;
+                neighborPre = geometry.linear(blockIndex, lineIndex, nextIndex - 1);
+                phyBlock = geometry.linear(blockIndex, lineIndex, nextIndex);
+                if (nextIndex < geometry.levelPerChip() - 1) neighborNext = geometry.linear(blockIndex, lineIndex, nextIndex + 1);
+                else neighborNext = ghostBlock(blockIndex, lineIndex, true);
                 this->releaseTemper(neighborPre, phyBlock, neighborNext, m_udTemperPercent);
             }
         }
     }
 
     // line-exchange hear
-    for (int levelIndex = 0; levelIndex < m_levelPerChip; ++levelIndex) {
+    for (int levelIndex = 0; levelIndex < geometry.levelPerChip(); ++levelIndex) {
         for (preIndex = midLinePos - 1, nextIndex = midLinePos; preIndex >= 0;
              --preIndex, ++nextIndex) {
-            for (int blockIndex = 0; blockIndex < m_blockPerLine; ++blockIndex) {
+            for (int blockIndex = 0; blockIndex < geometry.blockPerLine(); ++blockIndex) {
                 // front partial
-                if (preIndex > 0) m_ssd->threeDimension2linear(blockIndex, preIndex -1, levelIndex, neighborPre);
+                if (preIndex > 0) neighborPre = geometry.linear(blockIndex, preIndex -1, levelIndex);
                 else neighborPre = -1;
-                m_ssd->threeDimension2linear(blockIndex, preIndex, levelIndex, phyBlock);
-                m_ssd->threeDimension2linear(blockIndex, preIndex + 1, levelIndex, neighborNext);
+                phyBlock = geometry.linear(blockIndex, preIndex, levelIndex);
+                neighborNext = geometry.linear(blockIndex, preIndex + 1, levelIndex);
                 this->releaseTemper(neighborPre, phyBlock, neighborNext, m_fbTemperPercent);
 
                 // back parti
-                m_ssd->threeDimension2linear(blockIndex, nextIndex -1, levelIndex, neighborPre);
-                m_ssd->threeDimension2linear(blockIndex, nextIndex, levelIndex, phyBlock);
-                if (nextIndex < m_linePerLevel - 1) m_ssd->threeDimension2linear(blockIndex, nextIndex + 1, levelIndex, neighborNext);
+                neighborPre = geometry.linear(blockIndex, nextIndex -1, levelIndex);
+                phyBlock = geometry.linear(blockIndex, nextIndex, levelIndex);
+                if (nextIndex < geometry.linePerLevel() - 1) neighborNext = geometry.linear(blockIndex, nextIndex + 1, levelIndex);
                 else neighborNext = -1;
                 this->releaseTemper(neighborPre, phyBlock, neighborNext, m_fbTemperPercent);
             }
@@ -1635,22 +3098,22 @@ void Executor::disspateTemper() {
     }
 
     // block-exchange heat
-    for (int levelIndex = 0; levelIndex < m_levelPerChip; ++levelIndex) {
-        for (int lineIndex = 0; lineIndex < m_linePerLevel; ++lineIndex) {
+    for (int levelIndex = 0; levelIndex < geometry.levelPerChip(); ++levelIndex) {
+        for (int lineIndex = 0; lineIndex < geometry.linePerLevel(); ++lineIndex) {
             for (preIndex = midBlockPos - 1, nextIndex = midBlockPos;
                  preIndex >= 0; --preIndex, ++nextIndex) {
 
                 // left partial
-                if (preIndex > 0) m_ssd->threeDimension2linear(preIndex -1, lineIndex, levelIndex, neighborPre);
+                if (preIndex > 0) neighborPre = geometry.linear(preIndex -1, lineIndex, levelIndex);
                 else neighborPre = -1;
-                m_ssd->threeDimension2linear(preIndex, lineIndex, levelIndex, phyBlock);
-                m_ssd->threeDimension2linear(preIndex + 1, lineIndex, levelIndex, neighborNext);
+                phyBlock = geometry.linear(preIndex, lineIndex, levelIndex);
+                neighborNext = geometry.linear(preIndex + 1, lineIndex, levelIndex);
                 this->releaseTemper(neighborPre, phyBlock, neighborNext, m_lrTemperPercent);
 
                 // right partial
-                m_ssd->threeDimension2linear(nextIndex - 1, lineIndex, levelIndex, neighborPre);
-                m_ssd->threeDimension2linear(nextIndex, lineIndex, levelIndex, phyBlock);
-                if (nextIndex < m_blockPerLine -1) m_ssd->threeDimension2linear(nextIndex + 1, lineIndex, levelIndex, neighborNext);
+                neighborPre = geometry.linear(nextIndex - 1, lineIndex, levelIndex);
+                phyBlock = geometry.linear(nextIndex, lineIndex, levelIndex);
+                if (nextIndex < geometry.blockPerLine() -1) neighborNext = geometry.linear(nextIndex + 1, lineIndex, levelIndex);
                 else neighborNext = -1;
                 this->releaseTemper(neighborPre, phyBlock, neighborNext, m_lrTemperPercent);
 
@@ -1659,16 +3122,59 @@ void Executor::disspateTemper() {
     }
 }
 
+void Executor::disspateTemper() {
+    FTL_PROFILE_SCOPE(PROFILE_DISSIPATE);
+    // the common power-of-two geometries get their address math folded
+    int geometryShift[3] = {-1, -1, -1},
+            geometrySize[3] = {m_blockPerLine, m_linePerLevel, m_levelPerChip};
+    for (int dimension = 0; dimension < 3; ++dimension) {
+        for (int shift = 0; shift < 16; ++shift) {
+            if ((1 << shift) == geometrySize[dimension]) geometryShift[dimension] = shift;
+        }
+    }
+    int geometryKey = (geometryShift[0] << 16) | (geometryShift[1] << 8) | geometryShift[2];
+    if (geometryShift[0] < 0 || geometryShift[1] < 0 || geometryShift[2] < 0) geometryKey = -1;
+
+    switch (geometryKey) {
+    case (7 << 16) | (6 << 8) | 4: dissipateKernel(Pow2Geometry<7, 6, 4>()); break;
+    case (6 << 16) | (6 << 8) | 4: dissipateKernel(Pow2Geometry<6, 6, 4>()); break;
+    case (6 << 16) | (5 << 8) | 3: dissipateKernel(Pow2Geometry<6, 5, 3>()); break;
+    case (5 << 16) | (5 << 8) | 3: dissipateKernel(Pow2Geometry<5, 5, 3>()); break;
+    case (4 << 16) | (4 << 8) | 3: dissipateKernel(Pow2Geometry<4, 4, 3>()); break;
+    default:
+        dissipateKernel(GenericGeometry(m_blockPerLine, m_linePerLevel, m_levelPerChip));
+        break;
+    }
+
+    // level temperature sensor, serves level-scope throttling & peak temper
+    int blockPerLevel = m_blockPerLine * m_linePerLevel;
+    for (int levelIndex = 0; levelIndex < m_levelPerChip; ++levelIndex) {
+        double maxTemper = 25;
+        for (int blockIndex = levelIndex * blockPerLevel;
+             blockIndex < (levelIndex + 1) * blockPerLevel; ++blockIndex) {
+            if (m_ssd->m_blockData[blockIndex]->getTemper() > maxTemper) {
+                maxTemper = m_ssd->m_blockData[blockIndex]->getTemper();
+            }
+        }
+        if (m_throttleScope == 1) m_levelMaxTemper[levelIndex] = maxTemper;
+        if (maxTemper > m_peakTemper) m_peakTemper = maxTemper;
+    }
+
+    m_ssd->decayHeat();
+}
+
 void Executor::releaseTemper(int neighborPre, int phyBlock, int neighborNext,
                              double percent) {
     double preTemper = 0, phyTemper = 0, nextTemper = 0;
 
     if (neighborPre == -1) preTemper = 25;
+    else if (neighborPre >= m_physicBlock) preTemper = m_ghostTemper[neighborPre - m_physicBlock];
     else preTemper = m_ssd->m_blockData[neighborPre]->getTemper();
 
     phyTemper = m_ssd->m_blockData[phyBlock]->getTemper();
 
     if (neighborNext == -1) nextTemper = 25;
+    else if (neighborNext >= m_physicBlock) nextTemper = m_ghostTemper[neighborNext - m_physicBlock];
     else nextTemper = m_ssd->m_blockData[neighborNext]->getTemper();
 
 
@@ -1712,20 +3218,33 @@ void Executor::releaseTemper(int neighborPre, int phyBlock, int neighborNext,
     temperArr[0] += midMinGap;
 
     for (int index = 0; index < 3; ++index) {
-        if (blockArr[index] != -1) {
+        if (blockArr[index] >= m_physicBlock) {
+            // the owner partition updates the real block
+            m_ghostTemper[blockArr[index] - m_physicBlock] = temperArr[index];
+        } else if (blockArr[index] != -1) {
+            accrueErr(blockArr[index]);
             m_ssd->m_blockData[blockArr[index]]->setTemper(temperArr[index]);
         }
     }
 }
 
+int Executor::ghostBlock(int blockIndex, int lineIndex, bool isNext) {
+    if (isNext ? !m_hasGhostNext : !m_hasGhostPre) return -1;
+
+    int blockPerLevel = m_blockPerLine * m_linePerLevel;
+    return m_physicBlock + (isNext ? blockPerLevel : 0)
+            + lineIndex * m_blockPerLine + blockIndex;
+}
+
 void Executor::statisticTemper() {
-    static int ShotCount = 0;
+    FTL_PROFILE_SCOPE(PROFILE_STATISTICTEMPER);
+    if (m_temperShotPrefix.empty()) return;
 
     std::string filename; // shotTemperPrefix_times_level
     std::ofstream outStream;
     for (int levelIndex = 0; levelIndex < m_levelPerChip; ++levelIndex) {
         std::ostringstream filenameStream;
-        filenameStream << m_temperShotPrefix << "_" << ShotCount << "_"<<levelIndex;
+        filenameStream << m_temperShotPrefix << "_" << m_shotCount << "_"<<levelIndex;
         filename = filenameStream.str();
 
         outStream.open(filename.c_str(), std::ios_base::out);
@@ -1741,99 +3260,409 @@ void Executor::statisticTemper() {
         }
         outStream.close();
     }
-    ShotCount += 1;
+    m_shotCount += 1;
 
 }
 
 
 
-void Executor::injectErr() {
-    assert(m_temper2numBlockErr.size() > 0);
+void Executor::migrateHotspot() {
+    if (m_hotStreak.size() != m_physicBlock) m_hotStreak.assign(m_physicBlock, 0);
+    OpCauseScope opCauseScope(m_ssd, OPCAUSE_BACKGROUND);
 
+    // 0, sustained hotspots holding data
+    std::vector<std::pair<double, int> > hotBlock;
     for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
+        double blockTemper = m_ssd->m_blockData[blockIndex]->getTemper();
+        if (blockTemper - m_hotspotTemper > -LOWESTGAP) ++m_hotStreak[blockIndex];
+        else m_hotStreak[blockIndex] = 0;
+
+        if (m_hotStreak[blockIndex] >= m_hotspotRound &&
+                m_ssd->m_blockData[blockIndex]->getIsFree() == false) {
+            hotBlock.push_back(std::make_pair(blockTemper, blockIndex));
+        }
+    }
+    if (hotBlock.empty()) return;
+    std::sort(hotBlock.rbegin(), hotBlock.rend());
+
+    // 1, owner logic block of every physic block
+    std::vector<int> ownerLogic(m_physicBlock, -1);
+    for (int logicBlock = 0; logicBlock < m_logicBlock; ++logicBlock) {
+        for (int phyBlock = m_ssd->m_entryTable[logicBlock]; phyBlock != -1;
+             phyBlock = m_ssd->m_replaceTable[phyBlock]) {
+            ownerLogic[phyBlock] = logicBlock;
+        }
+    }
+
+    // 2, move the hottest chains first, within the budget
+    int budget = m_migrateBudget;
+    for (int hotIndex = 0; hotIndex < hotBlock.size(); ++hotIndex) {
+        int hotPhyBlock = hotBlock[hotIndex].second,
+                logicBlock = ownerLogic[hotPhyBlock];
+        // keep the reserve for gc
+        if (m_ssd->m_freeBlock.size() <= m_minimumFreeBlock) break;
+        // FTLs without chains move the hot block alone
+        if (logicBlock == -1) {
+            int numValid = 0;
+            for (int pageIndex = 0; pageIndex < m_pagePerBlock; ++pageIndex) {
+                if (m_ssd->m_blockData[hotPhyBlock]->getPage(pageIndex)->getValid()) ++numValid;
+            }
+            if (numValid > budget) continue;
+
+            int numMoved = m_ssd->relocateBlock(hotPhyBlock, false);
+            if (numMoved <= 0) continue;
+            budget -= numMoved;
+            ++m_migrateChain;
+            m_migratePage += numMoved;
+            ++m_migrateErase;
+            continue;
+        }
+
+        int numValid = 0, numBlock = 0;
+        for (int phyBlock = m_ssd->m_entryTable[logicBlock]; phyBlock != -1;
+             phyBlock = m_ssd->m_replaceTable[phyBlock], ++numBlock) {
+            ownerLogic[phyBlock] = -1;
+            for (int pageIndex = 0; pageIndex < m_pagePerBlock; ++pageIndex) {
+                if (m_ssd->m_blockData[phyBlock]->getPage(pageIndex)->getValid()) ++numValid;
+            }
+        }
+        if (numValid > budget) continue;
+
+        std::list<int>::iterator iterBlock = m_ssd->pickCoolBlock();
+        int targetBlock = *iterBlock;
+        m_ssd->m_freeBlock.erase(iterBlock);
+        m_ssd->m_blockData[targetBlock]->setIsFree(false);
+
+        budget -= m_ssd->mergeChain(logicBlock, targetBlock);
+        ++m_migrateChain;
+        m_migratePage += numValid;
+        m_migrateErase += numBlock;
+    }
+}
+
+
+
+void Executor::scrub() {
+    ++m_scrubRun;
+    OpCauseScope opCauseScope(m_ssd, OPCAUSE_BACKGROUND);
+    int refreshErrCount = static_cast<int>(m_scrubThreshold * m_eccNumBit),
+            decodeBit = deepestDecodeBit();
+
+    std::vector<int> ownerLogic;
+    int budget = m_scrubBudget;
+    for (int numPatrol = 0; numPatrol < m_physicBlock && budget > 0; ++numPatrol) {
+        int blockIndex = m_scrubCursor,
+                firstPage = m_scrubPageCursor,
+                worstErrCount = m_scrubWorstErr;
+        m_scrubCursor = (m_scrubCursor + 1) % m_physicBlock;
+        m_scrubPageCursor = 0;
+        m_scrubWorstErr = 0;
+
+        BlockData *blockData = m_ssd->m_blockData[blockIndex];
+        if (blockData->getIsFree()) continue;
+        // a block erased since it was cut short is patrolled from the start
+        if (blockData->getEraseCount() != m_scrubEraseCount) {
+            firstPage = 0;
+            worstErrCount = 0;
+        }
+        settleErr(blockIndex);
+
+        // patrol read of the valid pages, decoded as deep as each one needs;
+        // a block the budget cuts short resumes at the same page next run
+        bool cutShort = false;
+        for (int pageIndex = firstPage; pageIndex < m_pagePerBlock; ++pageIndex) {
+            PageData *pageData = blockData->getPage(pageIndex);
+            if (pageData->getValid() == false) continue;
+            if (budget <= 0) {
+                m_scrubCursor = blockIndex;
+                m_scrubPageCursor = pageIndex;
+                m_scrubEraseCount = blockData->getEraseCount();
+                m_scrubWorstErr = worstErrCount;
+                cutShort = true;
+                break;
+            }
+
+            checkTime(m_readPageTime);
+            m_ssd->countFlash(FLASH_READPAGE);
+            checkTemper(blockIndex, m_readPageTemper);
+            --budget;
+            ++m_scrubPageRead;
+            // a page no decode level corrects gains nothing from a refresh
+            if (decodePage(blockIndex, pageData->getErrCount()) >= 0) {
+                worstErrCount = std::max(worstErrCount, pageData->getErrCount());
+            }
+        }
+        // judge the block only once all of its pages are patrolled
+        if (cutShort) break;
+        if (worstErrCount < refreshErrCount || worstErrCount == 0) continue;
+        // keep the reserve for gc
+        if (m_ssd->m_freeBlock.size() <= m_minimumFreeBlock) continue;
+
+        if (ownerLogic.empty()) {
+            ownerLogic.assign(m_physicBlock, -1);
+            for (int logicBlock = 0; logicBlock < m_logicBlock; ++logicBlock) {
+                for (int phyBlock = m_ssd->m_entryTable[logicBlock]; phyBlock != -1;
+                     phyBlock = m_ssd->m_replaceTable[phyBlock]) {
+                    ownerLogic[phyBlock] = logicBlock;
+                }
+            }
+        }
+        int logicBlock = ownerLogic[blockIndex];
+        // FTLs without chains refresh the block alone
+        if (logicBlock == -1) {
+            int numNearEcc = 0, numOverEcc = 0, numLost = 0;
+            for (int pageIndex = 0; pageIndex < m_pagePerBlock; ++pageIndex) {
+                PageData *pageData = blockData->getPage(pageIndex);
+                if (pageData->getValid() == false) continue;
+                if (pageData->getErrCount() > decodeBit) ++numLost;
+                else if (pageData->getErrCount() > m_eccNumBit) ++numOverEcc;
+                else if (pageData->getErrCount() >= refreshErrCount) ++numNearEcc;
+            }
+
+            int numMoved = m_ssd->relocateBlock(blockIndex, true);
+            if (numMoved <= 0) continue;
+            m_scrubNearEccPage += numNearEcc;
+            m_scrubOverEccPage += numOverEcc;
+            m_scrubLostPage += numLost;
+            m_scrubRefreshPage += numMoved;
+            ++m_scrubRefreshErase;
+            ++m_scrubRefreshChain;
+            continue;
+        }
+
+        // refresh the whole chain into a cool block
+        int numBlock = 0;
+        for (int phyBlock = m_ssd->m_entryTable[logicBlock]; phyBlock != -1;
+             phyBlock = m_ssd->m_replaceTable[phyBlock], ++numBlock) {
+            ownerLogic[phyBlock] = -1;
+            for (int pageIndex = 0; pageIndex < m_pagePerBlock; ++pageIndex) {
+                PageData *pageData = m_ssd->m_blockData[phyBlock]->getPage(pageIndex);
+                if (pageData->getValid() == false) continue;
+                if (pageData->getErrCount() > decodeBit) ++m_scrubLostPage;
+                else if (pageData->getErrCount() > m_eccNumBit) ++m_scrubOverEccPage;
+                else if (pageData->getErrCount() >= refreshErrCount) ++m_scrubNearEccPage;
+            }
+        }
+
+        std::list<int>::iterator iterBlock = m_ssd->pickCoolBlock();
+        int targetBlock = *iterBlock;
+        m_ssd->m_freeBlock.erase(iterBlock);
+        m_ssd->m_blockData[targetBlock]->setIsFree(false);
+
+        m_scrubRefreshPage += m_ssd->mergeChain(logicBlock, targetBlock, true);
+        m_scrubRefreshErase += numBlock;
+        ++m_scrubRefreshChain;
+    }
+}
+
+
+
+// split [0, numBlock) into numThread ranges, the calling thread takes the last
+// one; rangeFunc(startBlock, endBlock) returns the errors it injected
+template <typename RangeFunc>
+static long long parallelForBlock(int numThread, int numBlock, RangeFunc rangeFunc) {
+    numThread = std::max(1, std::min(numThread, numBlock));
+    std::vector<long long> errCountArr(numThread, 0);
+    std::vector<std::thread> workerArr;
+    ProfileRun *profileRun = currentProfileRun();
+
+    for (int threadIndex = 0; threadIndex < numThread; ++threadIndex) {
+        int startBlock = static_cast<long long>(numBlock) * threadIndex / numThread,
+                endBlock = static_cast<long long>(numBlock) * (threadIndex + 1) / numThread;
+        long long &errCount = errCountArr[threadIndex];
+
+        if (threadIndex == numThread - 1) {
+            errCount = rangeFunc(startBlock, endBlock);
+        } else {
+            workerArr.push_back(std::thread([&rangeFunc, startBlock, endBlock, &errCount, profileRun]() {
+                ProfileRunScope profileRunScope(profileRun);
+                errCount = rangeFunc(startBlock, endBlock);
+            }));
+        }
+    }
+    for (int index = 0; index < workerArr.size(); ++index) {
+        workerArr[index].join();
+    }
+
+    long long errAmount = 0;
+    for (int threadIndex = 0; threadIndex < numThread; ++threadIndex) {
+        errAmount += errCountArr[threadIndex];
+    }
+    return errAmount;
+}
 
-        double blockTemper = m_ssd->m_blockData[blockIndex]->getTemper(),
-                temperIndex= 0;
-        std::map<double, int>::iterator iterMap = m_temper2numBlockErr.begin();
-        for (; iterMap != m_temper2numBlockErr.end() &&
-             blockTemper - iterMap->first >= LOWESTGAP; ++iterMap) {
-                temperIndex = iterMap->first;
+void Executor::injectErr() {
+    FTL_PROFILE_SCOPE(PROFILE_INJECTERR);
+    assert(m_errTemperStage.size() > 0);
+
+    // every block draws from its own (seed, block, epoch) stream,
+    // so the split between threads doesn't change the result
+    m_injectErrCount += parallelForBlock(m_numThread, m_physicBlock,
+                                         [this](int startBlock, int endBlock) {
+        return injectErrRange(startBlock, endBlock);
+    });
+    ++m_injectEpoch;
+}
+
+void Executor::accrueErr(int blockIndex) {
+    if (m_lazyErr == false) return;
+
+    BlockData *blockData = m_ssd->m_blockData[blockIndex];
+    double duration = m_simulateTime - blockData->getDoseTime();
+    if (duration <= 0) return;
+
+    // erased blocks accrue nothing, their errors would be dropped at program
+    if (blockData->getProgramTime() < 0) {
+        blockData->setErrDose(0, m_simulateTime);
+        return;
+    }
+    blockData->setErrDose(blockData->getErrDose() +
+                          errRateOfBlock(blockIndex) * duration / m_createErrInterval,
+                          m_simulateTime);
+}
+
+int Executor::settleErr(int blockIndex) {
+    int numInjected = settleErrUncounted(blockIndex);
+    m_injectErrCount += numInjected;
+    return numInjected;
+}
+
+int Executor::settleErrUncounted(int blockIndex) {
+    if (m_lazyErr == false) return 0;
+
+    accrueErr(blockIndex);
+    BlockData *blockData = m_ssd->m_blockData[blockIndex];
+    int errCount = static_cast<int>(blockData->getErrDose());
+    if (errCount <= 0) return 0;
+
+    // the fraction stays for the next settlement
+    blockData->setErrDose(blockData->getErrDose() - errCount, blockData->getDoseTime());
+
+    CounterRandom random(m_randomSeed, blockIndex, blockData->nextSettleEpoch() | 0x40000000u);
+    return createErrForBlock(blockIndex, errCount, random);
+}
+
+void Executor::settleAllErr() {
+    m_injectErrCount += parallelForBlock(m_numThread, m_physicBlock,
+                                         [this](int startBlock, int endBlock) {
+        long long numInjected = 0;
+        for (int blockIndex = startBlock; blockIndex < endBlock; ++blockIndex) {
+            numInjected += settleErrUncounted(blockIndex);
+        }
+        return numInjected;
+    });
+}
+
+long long Executor::injectErrRange(int startBlock, int endBlock) {
+    std::vector<double> errRate(endBlock - startBlock);
+    evalErrRate(startBlock, endBlock, errRate.data());
+
+    long long numInjected = 0;
+    for (int blockIndex = startBlock; blockIndex < endBlock; ++blockIndex) {
+        double expectErr = errRate[blockIndex - startBlock];
+        int errCount = static_cast<int>(expectErr);
+
+        // the fraction is rounded by its own stream, apart from the error positions
+        if (expectErr - errCount > LOWESTGAP) {
+            CounterRandom random(m_randomSeed, blockIndex, m_injectEpoch | 0x80000000u);
+            if (random.uniformReal() < expectErr - errCount) ++errCount;
+        }
+        CounterRandom random(m_randomSeed, blockIndex, m_injectEpoch);
+        numInjected += createErrForBlock(blockIndex, errCount, random);
+    }
+    return numInjected;
+}
+
+void Executor::evalErrRate(int startBlock, int endBlock, double *errRate) {
+    int numBlock = endBlock - startBlock;
+    std::vector<double> eraseCount(numBlock), age(numBlock);
+
+    // gather
+    for (int index = 0; index < numBlock; ++index) {
+        BlockData *blockData = m_ssd->m_blockData[startBlock + index];
+        errRate[index] = errCountOfTemper(blockData->getTemper());
+        eraseCount[index] = blockData->getEraseCount();
+        age[index] = blockData->getProgramTime() < 0 ? 0 : m_simulateTime - blockData->getProgramTime();
+    }
+
+    // straight loops over the arrays, left to the vectorizer
+    if (m_wearCoef != 0) {
+        for (int index = 0; index < numBlock; ++index) {
+            errRate[index] *= 1 + m_wearCoef * std::pow(eraseCount[index] / m_wearScale, m_wearExponent);
         }
-        if (iterMap == m_temper2numBlockErr.end()) {
-            --iterMap;
-            temperIndex = iterMap->first;
+    }
+    if (m_retentionCoef != 0) {
+        for (int index = 0; index < numBlock; ++index) {
+            errRate[index] *= 1 + m_retentionCoef * std::log1p(age[index] / m_retentionScale);
         }
-        createErrForBlock(blockIndex, m_temper2numBlockErr[temperIndex]);
     }
 }
 
-void Executor::createErrForBlock(int blockIndex, int errCount) {
+double Executor::errRateOfBlock(int blockIndex) {
+    BlockData *blockData = m_ssd->m_blockData[blockIndex];
+    double errRate = errCountOfTemper(blockData->getTemper());
+
+    if (m_wearCoef != 0) {
+        errRate *= 1 + m_wearCoef * std::pow(blockData->getEraseCount() / m_wearScale, m_wearExponent);
+    }
+    if (m_retentionCoef != 0 && blockData->getProgramTime() >= 0) {
+        errRate *= 1 + m_retentionCoef * std::log1p((m_simulateTime - blockData->getProgramTime()) / m_retentionScale);
+    }
+    return errRate;
+}
+
+int Executor::errCountOfTemper(double temper) {
+    std::vector<double>::iterator iterStage =
+            std::upper_bound(m_errTemperStage.begin(), m_errTemperStage.end(), temper - LOWESTGAP);
+    if (iterStage == m_errTemperStage.begin()) return 0;
+    return m_errCountStage[iterStage - m_errTemperStage.begin() - 1];
+}
+
+int Executor::createErrForBlock(int blockIndex, int errCount, CounterRandom &random) {
+    if (errCount <= 0) return 0;
+
+    int numInjected = 0;
 
     if (m_isRealData) {
-        char *pageData = new char[m_bytePerPage];
         for (int errIndex = 0; errIndex < errCount; ++errIndex) {
             // generate byte index
-            std::default_random_engine generatorByte(time(nullptr));
-            std::uniform_int_distribution<int> distributionByte(0, m_bytePerPage * m_pagePerBlock - 1);
-            int byteIndexGlobal = distributionByte(generatorByte),
+            int byteIndexGlobal = random.uniformInt(m_bytePerPage * m_pagePerBlock),
                     byteIndex = byteIndexGlobal % m_bytePerPage,
                     pageIndex = byteIndexGlobal / m_bytePerPage;
             // generate bit index
-            std::default_random_engine generatorBit(time(nullptr));
-            std::uniform_int_distribution<int> distributionBit(0, 7);
-            int bitIndex = distributionBit(generatorBit);
+            int bitIndex = random.uniformInt(8);
 
-            m_ssd->m_blockData[blockIndex]->getPage(pageIndex)->getDataAsBit(pageData);
-            pageData[byteIndex] ^= (1 << bitIndex);
-            m_ssd->m_blockData[blockIndex]->getPage(pageIndex)->setDataAsBit(pageData);
+            if (m_ssd->m_blockData[blockIndex]->getPage(pageIndex)->flipBit(byteIndex * 8 + bitIndex)) {
+                ++numInjected;
+            }
         }
-        delete pageData;
     } else {
         for (int errIndex = 0; errIndex < errCount; ++errIndex) {
 
             // generate page index
-            std::default_random_engine generatorPage(time(nullptr));
-            std::uniform_int_distribution<int> distributionPage(0, m_pagePerBlock - 1);
-
-            int pageIndex = distributionPage(generatorPage),
+            int pageIndex = random.uniformInt(m_pagePerBlock),
                     numPageErr = 0;
 
             m_ssd->m_blockData[blockIndex]->getPage(pageIndex)->getDataAsErrCount(numPageErr);
             if (numPageErr + 1 > m_bytePerPage * 8) continue;
             numPageErr += 1;
+            ++numInjected;
             m_ssd->m_blockData[blockIndex]->getPage(pageIndex)->setDataAsErrCount(numPageErr);
         }
     }
+    return numInjected;
 }
 
 void Executor::statisticErr() {
+    FTL_PROFILE_SCOPE(PROFILE_STATISTICERR);
+    if (m_lazyErr) settleAllErr();
 
-    int errAmount = 0;
-    char byte = 0, bitModel = 1, *pageDataBit = m_isRealData ? new char[m_bytePerPage] : NULL;
-
-    int errCount = 0;
+    // the pages keep the block totals up to date
+    long long errAmount = 0;
     for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
-        for (int pageIndex = 0; pageIndex < m_pagePerBlock; ++pageIndex) {
-
-            errCount = 0;
-            if (m_isRealData) {
-                m_ssd->m_blockData[blockIndex]->getPage(pageIndex)->getDataAsBit(pageDataBit);
-                for (int byteIndex = 0; byteIndex < m_bytePerPage; ++byteIndex) {
-                    byte = pageDataBit[byteIndex];
-                    bitModel = 1;
-                    for (int bitIndex = 0; bitIndex < 8; ++bitIndex) {
-                        bitModel <<= 1;
-                        if (byte & bitModel) errCount += 1;
-                    }
-                }
-                if (errCount > m_eccNumBit) errAmount += errCount;
-            } else {
-                m_ssd->m_blockData[blockIndex]->getPage(pageIndex)->getDataAsErrCount(errCount);
-                if (errCount > m_eccNumBit) errAmount += errCount;
-            }
-        }
+        errAmount += m_ssd->m_blockData[blockIndex]->getErrOverEcc();
     }
-    if (pageDataBit) delete pageDataBit;
+    if (m_errorFilename.empty()) return;
 
     std::ofstream outStream;
     outStream.open(m_errorFilename.c_str(), std::ios_base::app);
@@ -1843,38 +3672,568 @@ void Executor::statisticErr() {
 
 
 
-bool Executor::processRequest(std::ifstream &inStream) {
+// sampled drive state, chain buckets count the logic blocks by the
+// physical blocks holding their data, the last one 4 & more
+enum {
+    TELEMETRY_TIME,
+    TELEMETRY_REQUEST,
+    TELEMETRY_FREEBLOCK,
+    TELEMETRY_GC,
+    TELEMETRY_GCCOPYPAGE,
+    TELEMETRY_HOSTWRITE,
+    TELEMETRY_FLASHWRITE,
+    TELEMETRY_ERASE,
+    TELEMETRY_AVGTEMPER,
+    TELEMETRY_MAXTEMPER,
+    TELEMETRY_INJECTERR,
+    TELEMETRY_ERROVERECC,
+    TELEMETRY_UNCORRECTABLE,
+    TELEMETRY_CHAIN,
+    NUMTELEMETRYCOLUMN = TELEMETRY_CHAIN + 5
+};
+
+static const char *TELEMETRY_COLUMN_NAME[NUMTELEMETRYCOLUMN] = {
+    "time", "request", "freeBlock", "gcCount", "gcCopyPage", "hostWrite", "flashWrite",
+    "eraseCount", "avgTemper", "maxTemper", "injectErr", "errOverEcc", "uncorrectableRead",
+    "chain0", "chain1", "chain2", "chain3", "chain4+"
+};
+
+void Executor::sampleTelemetry() {
+    if (m_telemetry == NULL) {
+        m_telemetry = new TelemetryWriter;
+        for (int column = 0; column < NUMTELEMETRYCOLUMN; ++column) {
+            m_telemetry->addColumn(TELEMETRY_COLUMN_NAME[column], column == TELEMETRY_TIME
+                                   || column == TELEMETRY_AVGTEMPER || column == TELEMETRY_MAXTEMPER);
+        }
+        if (m_telemetry->open(m_summaryFilename + "_telemetry") == false) {
+            m_telemetryInterval = 0;
+            return;
+        }
+    }
 
-    static int requestCount = 0;
+    long long eraseCount = 0, errOverEcc = 0;
+    double avgTemper = 0, maxTemper = 0;
+    for (int blockIndex = 0; blockIndex < m_physicBlock; ++blockIndex) {
+        BlockData *blockData = m_ssd->m_blockData[blockIndex];
+        eraseCount += blockData->getEraseCount();
+        errOverEcc += blockData->getErrOverEcc();
+        avgTemper += blockData->getTemper();
+        maxTemper = std::max(maxTemper, blockData->getTemper());
+    }
+    avgTemper /= m_physicBlock;
 
-    static char *dataModel = new char[m_bytePerPage];
-    static int errCount = 0;
+    long long chainCount[NUMTELEMETRYCOLUMN - TELEMETRY_CHAIN] = {0};
+    int lastBucket = NUMTELEMETRYCOLUMN - TELEMETRY_CHAIN - 1;
+    for (int logicBlock = 0; logicBlock < m_logicBlock; ++logicBlock) {
+        ++chainCount[std::min(m_ssd->chainLength(logicBlock), lastBucket)];
+    }
 
-    int logicNum;
-    std::string cmd;
+    m_telemetry->setReal(TELEMETRY_TIME, m_simulateTime);
+    m_telemetry->setInt(TELEMETRY_REQUEST, m_requestCount);
+    m_telemetry->setInt(TELEMETRY_FREEBLOCK, m_ssd->m_freeBlock.size());
+    m_telemetry->setInt(TELEMETRY_GC, m_ssd->m_gcCount);
+    m_telemetry->setInt(TELEMETRY_GCCOPYPAGE, m_ssd->m_gcCopyPage);
+    m_telemetry->setInt(TELEMETRY_HOSTWRITE, m_ssd->m_hostWrite);
+    long long flashProgram = 0;
+    for (int cause = 0; cause < NUMOPCAUSE; ++cause) flashProgram += m_ssd->m_flashOp[cause][FLASHOP_PROGRAM];
+    m_telemetry->setInt(TELEMETRY_FLASHWRITE, flashProgram);
+    m_telemetry->setInt(TELEMETRY_ERASE, eraseCount);
+    m_telemetry->setReal(TELEMETRY_AVGTEMPER, avgTemper);
+    m_telemetry->setReal(TELEMETRY_MAXTEMPER, maxTemper);
+    m_telemetry->setInt(TELEMETRY_INJECTERR, m_injectErrCount);
+    m_telemetry->setInt(TELEMETRY_ERROVERECC, errOverEcc);
+    m_telemetry->setInt(TELEMETRY_UNCORRECTABLE, m_uncorrectableRead);
+    for (int bucket = 0; bucket <= lastBucket; ++bucket) {
+        m_telemetry->setInt(TELEMETRY_CHAIN + bucket, chainCount[bucket]);
+    }
+    m_telemetry->endRow();
+}
 
-    PageData pageData;
-    for (int lineIndex = 0; inStream.eof() == false; ++lineIndex) {
+
+
+bool Executor::processRequest(TraceReader &traceReader) {
+
+    std::vector<char> dataModel(m_bytePerPage, 0);
+    int errCount = 0;
+
+    TraceRecord record;
+    PageData pageData(&m_ssd->m_dataContext);
+    while (traceReader.next(record)) {
         if (m_isRealData == true) {
-            memset(dataModel, 0, m_bytePerPage);
-            pageData.setDataAsBit(dataModel);
+            pageData.setDataAsBit(&dataModel[0]);
         } else {
             errCount = 0;
             pageData.setDataAsErrCount(errCount);
         }
+        executeRequest(record.m_isWrite, record.m_logicNum, pageData);
+    }
+    return traceReader.fail() == false;
+}
 
-        inStream >> logicNum >> cmd;
-        if (cmd == std::string("r")) {
-            m_ssd->readPage(logicNum, &pageData);
-            std::cout <<requestCount++ <<" r " << logicNum << std::endl;
-        } else if (cmd == std::string("w")) {
-            m_ssd->writePage(logicNum, &pageData);
-            std::cout << requestCount++ << " w " << logicNum << std::endl;
-        } else {
-            std::cerr << "Fail to process request line " << lineIndex << std::endl;
-            std::cout << "w " << logicNum << std::endl;
+int Executor::executeRequest(bool isWrite, int logicNum, PageData &pageData) {
+    int phyBlock = -1;
+    if (isWrite) {
+        phyBlock = m_ssd->writePage(logicNum, &pageData);
+        if (m_verbose) std::cout << m_requestCount << " w " << logicNum << std::endl;
+    } else {
+        phyBlock = m_ssd->readPage(logicNum, &pageData);
+        if (m_verbose) std::cout << m_requestCount << " r " << logicNum << std::endl;
+    }
+    ++m_requestCount;
+    runBackgroundTask();
+    return phyBlock;
+}
+
+
+
+// ====================PartitionExecutor=========================
+
+const static int PARTITION_CHUNK = 1 << 16; // trace lines routed per refill
+
+PartitionExecutor::PartitionExecutor() : m_numPartition(0), m_traceIndex(0),
+    m_traceEnd(false), m_traceFail(false), m_arriveCount(0), m_boundary(0),
+    m_dissipate(false), m_finish(false), m_roundCount(0), m_epochCount(0), m_profileRun(NULL) {
+}
+
+PartitionExecutor::~PartitionExecutor() {
+    for (int partIndex = 0; partIndex < m_ssd.size(); ++partIndex) {
+        delete m_ssd[partIndex];
+    }
+    for (int partIndex = 0; partIndex < m_executor.size(); ++partIndex) {
+        delete m_executor[partIndex];
+    }
+    deleteProfileRun(m_profileRun);
+}
+
+bool PartitionExecutor::init(std::string configFileName, std::string methodNum, int numPartition) {
+    if (m_config.readConfigFile(configFileName) == false) return false;
+
+    if (numPartition < 2 || m_config.m_levelPerChip % numPartition != 0
+            || m_config.m_levelPerChip / numPartition < 2) {
+        std::cerr << "Levels should split evenly into partitions of 2 levels at least !!!" << std::endl;
+        return false;
+    }
+    if (m_config.m_dataFromFile) {
+        std::cerr << "Partitioned simulation starts from an empty SSD !!!" << std::endl;
+        return false;
+    }
+
+    m_numPartition = numPartition;
+    int levelPerPart = m_config.m_levelPerChip / numPartition,
+            blockPerLevel = m_config.m_blockPerLine * m_config.m_linePerLevel;
+
+    for (int partIndex = 0; partIndex < numPartition; ++partIndex) {
+        SSD *ssd = createSSD(methodNum);
+        if (ssd == NULL) {
+            std::cerr << "Wrong method number !!!" << std::endl;
             return false;
         }
+        Executor *executor = new Executor;
+        m_ssd.push_back(ssd);
+        m_executor.push_back(executor);
+        if (executor->readConfigFile(configFileName) == false) return false;
+
+        executor->m_levelPerChip = levelPerPart;
+        executor->m_physicBlock = blockPerLevel * levelPerPart;
+        // logic blocks b with b % numPartition == partIndex
+        executor->m_logicBlock = (m_config.m_logicBlock - partIndex + numPartition - 1) / numPartition;
+        if (m_config.m_throttleScope == 1) executor->m_levelMaxTemper.assign(levelPerPart, 25);
+
+        executor->m_randomSeed = m_config.m_randomSeed + partIndex;
+        executor->m_numThread = std::max(1, m_config.m_numThread / numPartition);
+        executor->m_verbose = false;
+
+        executor->m_barrierDissipate = true;
+        executor->m_hasGhostPre = partIndex > 0;
+        executor->m_hasGhostNext = partIndex < numPartition - 1;
+        executor->m_ghostTemper.assign(2 * blockPerLevel, 25);
+
+        executor->setSSD(ssd);
+        ssd->allocateSpace(executor);
+        executor->initData();
+
+        std::ostringstream prefixStream;
+        prefixStream << "part" << partIndex << "_";
+        executor->redirectOutput(prefixStream.str(), true);
     }
+
+    m_queue.resize(numPartition);
+    m_cursor.assign(numPartition, 0);
     return true;
 }
+
+bool PartitionExecutor::refill() {
+    for (int partIndex = 0; partIndex < m_numPartition; ++partIndex) {
+        m_queue[partIndex].erase(m_queue[partIndex].begin(),
+                                 m_queue[partIndex].begin() + m_cursor[partIndex]);
+        m_cursor[partIndex] = 0;
+    }
+
+    int pagePerBlock = m_config.m_pagePerBlock;
+    TraceRecord record;
+    for (int lineCount = 0; lineCount < PARTITION_CHUNK && m_traceEnd == false; ) {
+        if (m_traceReader.isOpen() == false) {
+            if (m_traceIndex >= m_config.m_traceFileNameList.size()) {
+                m_traceEnd = true;
+                break;
+            }
+            const std::string &traceFilename = m_config.m_traceFileNameList[m_traceIndex++];
+            if (m_traceReader.open(traceFilename) == false) {
+                std::cerr << "Fail to open tracefile" << traceFilename << std::endl;
+            }
+            continue;
+        }
+
+        if (m_traceReader.next(record) == false) {
+            if (m_traceReader.fail()) return false;
+            m_traceReader.close();
+            continue;
+        }
+
+        int logicNum = record.m_logicNum, logicBlock = logicNum / pagePerBlock;
+        Request request;
+        request.logicNum = logicBlock / m_numPartition * pagePerBlock + logicNum % pagePerBlock;
+        request.isWrite = record.m_isWrite;
+        m_queue[logicBlock % m_numPartition].push_back(request);
+        ++lineCount;
+    }
+    return true;
+}
+
+void PartitionExecutor::exchangeGhost() {
+    int blockPerLevel = m_config.m_blockPerLine * m_config.m_linePerLevel;
+    for (int partIndex = 0; partIndex < m_numPartition; ++partIndex) {
+        Executor *executor = m_executor[partIndex];
+        if (executor->m_hasGhostPre) {
+            // bottom level of the partition above
+            SSD *ssd = m_ssd[partIndex - 1];
+            int firstBlock = ssd->m_physicBlock - blockPerLevel;
+            for (int slot = 0; slot < blockPerLevel; ++slot) {
+                executor->m_ghostTemper[slot] = ssd->m_blockData[firstBlock + slot]->getTemper();
+            }
+        }
+        if (executor->m_hasGhostNext) {
+            // top level of the partition below
+            SSD *ssd = m_ssd[partIndex + 1];
+            for (int slot = 0; slot < blockPerLevel; ++slot) {
+                executor->m_ghostTemper[blockPerLevel + slot] = ssd->m_blockData[slot]->getTemper();
+            }
+        }
+    }
+}
+
+void PartitionExecutor::endRound() {
+    ++m_roundCount;
+    if (m_traceFail) {
+        m_finish = true;
+        return;
+    }
+
+    bool needRefill = false, hasRequest = false;
+    for (int partIndex = 0; partIndex < m_numPartition; ++partIndex) {
+        if (m_cursor[partIndex] < m_queue[partIndex].size()) {
+            hasRequest = true;
+        } else if (m_executor[partIndex]->m_simulateTime < m_boundary) {
+            needRefill = true;
+        }
+    }
+
+    // a partition ran dry before the boundary, the epoch goes on
+    if (needRefill && m_traceEnd == false) {
+        if (refill() == false) {
+            m_traceFail = true;
+            m_finish = true;
+        }
+        m_dissipate = false;
+        return;
+    }
+    if (hasRequest == false && m_traceEnd) {
+        m_finish = true;
+        return;
+    }
+
+    for (int partIndex = 0; partIndex < m_numPartition; ++partIndex) {
+        Executor *executor = m_executor[partIndex];
+        if (executor->m_simulateTime < m_boundary) {
+            executor->checkTime(m_boundary - executor->m_simulateTime);
+            executor->runBackgroundTask();
+        }
+    }
+    exchangeGhost();
+    m_boundary += m_config.m_dissTemperInterval;
+    ++m_epochCount;
+    m_dissipate = true;
+}
+
+void PartitionExecutor::arriveBarrier() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    long long roundCount = m_roundCount;
+    if (++m_arriveCount == m_numPartition) {
+        m_arriveCount = 0;
+        endRound();
+        m_roundCond.notify_all();
+    } else {
+        m_roundCond.wait(lock, [&]() { return m_roundCount != roundCount; });
+    }
+}
+
+void PartitionExecutor::runPartition(int partIndex) {
+    ProfileRunScope profileRunScope(m_profileRun);
+    Executor *executor = m_executor[partIndex];
+    std::vector<char> dataModel(m_config.m_bytePerPage, 0);
+    PageData pageData(&m_ssd[partIndex]->m_dataContext);
+
+    for (;;) {
+        std::vector<Request> &queue = m_queue[partIndex];
+        size_t &cursor = m_cursor[partIndex];
+        for (; cursor < queue.size() && executor->m_simulateTime < m_boundary; ++cursor) {
+            if (m_config.m_isRealData) pageData.setDataAsBit(&dataModel[0]);
+            else pageData.setDataAsErrCount(0);
+            executor->executeRequest(queue[cursor].isWrite, queue[cursor].logicNum, pageData);
+        }
+
+        arriveBarrier();
+        if (m_finish) break;
+        if (m_dissipate) executor->disspateTemper();
+    }
+}
+
+bool PartitionExecutor::beginProcess() {
+    if (m_numPartition < 2) return false;
+    if (m_profileRun == NULL) m_profileRun = createProfileRun();
+    ProfileRunScope profileRunScope(m_profileRun);
+
+    m_boundary = m_config.m_dissTemperInterval > 0 ? m_config.m_dissTemperInterval : HUGE_VAL;
+    if (refill() == false) return false;
+
+    std::vector<std::thread> workerArr;
+    for (int partIndex = 0; partIndex < m_numPartition - 1; ++partIndex) {
+        workerArr.push_back(std::thread(&PartitionExecutor::runPartition, this, partIndex));
+    }
+    runPartition(m_numPartition - 1);
+    for (int index = 0; index < workerArr.size(); ++index) {
+        workerArr[index].join();
+    }
+    return m_traceFail == false;
+}
+
+bool PartitionExecutor::endProcess() {
+    ProfileRunScope profileRunScope(m_profileRun);
+    bool isOk = true;
+    for (int partIndex = 0; partIndex < m_numPartition; ++partIndex) {
+        isOk = m_executor[partIndex]->endProcess() && isOk;
+    }
+    isOk = writeProfile(m_profileRun, m_config.m_summaryFilename + "_profile") && isOk;
+    return writeBackSummary() && isOk;
+}
+
+bool PartitionExecutor::writeBackSummary() {
+    std::ofstream outStream;
+    outStream.open(m_config.m_summaryFilename.c_str(), std::ios_base::out);
+    if (!outStream.is_open()) {
+        std::cerr << "Fail open summary file !!!" << std::endl;
+        return false;
+    }
+
+    int maxEraseCount = 0;
+    double avgEraseCount = 0, maxTemper = 0, simulateTime = 0, peakTemper = 25,
+            throttleTime = 0, readLatencySum = 0, readLatencyMax = 0, sqrEraseCount = 0;
+    long long throttleEvent = 0, injectErrCount = 0, migrateChain = 0,
+            readCount = 0, uncorrectableRead = 0, scrubRefreshChain = 0,
+            hostWrite = 0, flashProgram = 0, gcProgram = 0, gcErasePage = 0;
+    for (int partIndex = 0; partIndex < m_numPartition; ++partIndex) {
+        SSD *ssd = m_ssd[partIndex];
+        for (int blockIndex = 0; blockIndex < ssd->m_physicBlock; ++blockIndex) {
+            int eraseCount = ssd->m_blockData[blockIndex]->getEraseCount();
+            maxEraseCount = std::max(maxEraseCount, eraseCount);
+            avgEraseCount += eraseCount;
+            sqrEraseCount += static_cast<double>(eraseCount) * eraseCount;
+            maxTemper = std::max(maxTemper, ssd->m_blockData[blockIndex]->getTemper());
+        }
+        hostWrite += ssd->m_hostWrite;
+        for (int cause = 0; cause < NUMOPCAUSE; ++cause) {
+            flashProgram += ssd->m_flashOp[cause][FLASHOP_PROGRAM];
+        }
+        gcProgram += ssd->m_flashOp[OPCAUSE_GC][FLASHOP_PROGRAM];
+        gcErasePage += ssd->m_flashOp[OPCAUSE_GC][FLASHOP_ERASE] * m_config.m_pagePerBlock;
+
+        Executor *executor = m_executor[partIndex];
+        simulateTime = std::max(simulateTime, executor->m_simulateTime);
+        peakTemper = std::max(peakTemper, executor->m_peakTemper);
+        throttleEvent += executor->m_throttleEvent;
+        throttleTime += executor->m_throttleTime;
+        injectErrCount += executor->m_injectErrCount;
+        migrateChain += executor->m_migrateChain;
+        readCount += executor->m_readCount;
+        uncorrectableRead += executor->m_uncorrectableRead;
+        readLatencySum += executor->m_readLatencySum;
+        readLatencyMax = std::max(readLatencyMax, executor->m_readLatencyMax);
+        scrubRefreshChain += executor->m_scrubRefreshChain;
+    }
+    avgEraseCount /= m_config.m_physicBlock;
+    sqrEraseCount /= m_config.m_physicBlock;
+
+    outStream << "maxEraseCount = " << maxEraseCount << "\n"
+              << "averageEraseCount = " << avgEraseCount << "\n"
+              << "maxTemper = " << maxTemper << "\n"
+              << "simulateTime = " << simulateTime << "\n";
+
+    outStream << "numPartition = " << m_numPartition << "\n"
+              << "epochCount = " << m_epochCount << "\n"
+              << "roundCount = " << m_roundCount << "\n"
+              << "partitionSimulateTime =";
+    for (int partIndex = 0; partIndex < m_numPartition; ++partIndex) {
+        outStream << " " << m_executor[partIndex]->m_simulateTime;
+    }
+    outStream << "\n";
+
+    outStream << "throttleEvent = " << throttleEvent << "\n"
+              << "throttleTime = " << throttleTime << "\n"
+              << "peakTemper = " << peakTemper << "\n"
+              << "injectErrCount = " << injectErrCount << "\n"
+              << "migrateChain = " << migrateChain << "\n"
+              << "readCount = " << readCount << "\n"
+              << "uncorrectableRead = " << uncorrectableRead << "\n"
+              << "avgReadLatency = " << (readCount ? readLatencySum / readCount : 0) << "\n"
+              << "maxReadLatency = " << readLatencyMax << "\n"
+              << "scrubRefreshChain = " << scrubRefreshChain << "\n";
+
+    double eraseDeviation = std::sqrt(std::max(0.0, sqrEraseCount - avgEraseCount * avgEraseCount));
+    outStream << "hostWrite = " << hostWrite << "\n"
+              << "flashProgram = " << flashProgram << "\n"
+              << "waf = " << (hostWrite > 0 ? static_cast<double>(flashProgram) / hostWrite : 0) << "\n"
+              << "gcEfficiency = "
+              << (gcErasePage > 0 ? 1 - static_cast<double>(gcProgram) / gcErasePage : 0) << "\n"
+              << "wearSpread = " << (avgEraseCount > 0 ? eraseDeviation / avgEraseCount : 0) << "\n";
+
+    outStream.close();
+    return true;
+}
+
+
+
+// ====================HostQueue=========================
+
+HostQueue::HostQueue(int numQueue, int numUnit) :
+    m_numQueue(numQueue < 1 ? 1 : numQueue), m_numUnit(numUnit < 1 ? 1 : numUnit) {
+}
+
+long long HostQueue::getNumCommand() {
+    return m_command.size();
+}
+
+bool HostQueue::record(Executor *executor, TraceReader &traceReader) {
+    SSD *ssd = executor->m_ssd;
+    std::vector<char> dataModel(executor->m_bytePerPage, 0);
+    PageData pageData(&ssd->m_dataContext);
+
+    TraceRecord record;
+    while (traceReader.next(record)) {
+        if (executor->m_isRealData) pageData.setDataAsBit(&dataModel[0]);
+        else pageData.setDataAsErrCount(0);
+
+        HostCommand command;
+        command.m_isWrite = record.m_isWrite;
+        double startTime = executor->m_simulateTime;
+        int phyBlock = executor->executeRequest(command.m_isWrite, record.m_logicNum, pageData);
+        command.m_serviceTime = executor->m_simulateTime - startTime;
+        command.m_unit = phyBlock < 0 ? -1 :
+                static_cast<long long>(phyBlock) * m_numUnit / ssd->m_physicBlock;
+        m_command.push_back(command);
+    }
+    return traceReader.fail() == false;
+}
+
+QueueDepthResult HostQueue::replay(int queueDepth) {
+    typedef std::pair<double, int> Completion; // time, command
+    std::priority_queue<Completion, std::vector<Completion>, std::greater<Completion> > completion;
+
+    int numCommand = m_command.size();
+    std::vector<double> submitTime(numCommand, 0), latency(numCommand, 0);
+    std::vector<std::deque<int> > unitQueue(m_numUnit);
+    std::vector<bool> unitBusy(m_numUnit, false);
+    std::vector<int> nextCommand(m_numQueue);
+    for (int queueIndex = 0; queueIndex < m_numQueue; ++queueIndex) nextCommand[queueIndex] = queueIndex;
+    double busyTime = 0;
+
+    // the host submits the next command of a queue, returns false once it is drained
+    auto submit = [&](int queueIndex, double now) {
+        int commandIndex = nextCommand[queueIndex];
+        if (commandIndex >= numCommand) return false;
+        nextCommand[queueIndex] += m_numQueue;
+
+        submitTime[commandIndex] = now;
+        const HostCommand &command = m_command[commandIndex];
+        if (command.m_unit < 0) {
+            completion.push(Completion(now + command.m_serviceTime, commandIndex));
+        } else if (unitBusy[command.m_unit] == false) {
+            unitBusy[command.m_unit] = true;
+            busyTime += command.m_serviceTime;
+            completion.push(Completion(now + command.m_serviceTime, commandIndex));
+        } else {
+            unitQueue[command.m_unit].push_back(commandIndex);
+        }
+        return true;
+    };
+
+    for (int queueIndex = 0; queueIndex < m_numQueue; ++queueIndex) {
+        for (int slot = 0; slot < queueDepth && submit(queueIndex, 0); ++slot) ;
+    }
+
+    double makespan = 0;
+    while (completion.empty() == false) {
+        double now = completion.top().first;
+        int commandIndex = completion.top().second;
+        completion.pop();
+
+        latency[commandIndex] = now - submitTime[commandIndex];
+        makespan = now;
+
+        int unit = m_command[commandIndex].m_unit;
+        if (unit >= 0) {
+            if (unitQueue[unit].empty()) {
+                unitBusy[unit] = false;
+            } else {
+                int dispatchIndex = unitQueue[unit].front();
+                unitQueue[unit].pop_front();
+                busyTime += m_command[dispatchIndex].m_serviceTime;
+                completion.push(Completion(now + m_command[dispatchIndex].m_serviceTime, dispatchIndex));
+            }
+        }
+        submit(commandIndex % m_numQueue, now);
+    }
+
+    QueueDepthResult result;
+    result.m_queueDepth = queueDepth;
+    result.m_numCommand = numCommand;
+    result.m_makespan = makespan;
+    result.m_iops = makespan > 0 ? numCommand / makespan * 1000 : 0;
+
+    double latencySum = 0, readSum = 0, writeSum = 0;
+    long long numRead = 0;
+    for (int commandIndex = 0; commandIndex < numCommand; ++commandIndex) {
+        latencySum += latency[commandIndex];
+        if (m_command[commandIndex].m_isWrite) {
+            writeSum += latency[commandIndex];
+        } else {
+            readSum += latency[commandIndex];
+            ++numRead;
+        }
+    }
+    result.m_avgLatency = numCommand ? latencySum / numCommand : 0;
+    result.m_avgReadLatency = numRead ? readSum / numRead : 0;
+    result.m_avgWriteLatency = numCommand - numRead ? writeSum / (numCommand - numRead) : 0;
+    result.m_unitBusy = makespan > 0 ? busyTime / (makespan * m_numUnit) : 0;
+
+    result.m_p50Latency = result.m_p99Latency = result.m_maxLatency = 0;
+    if (numCommand > 0) {
+        // high rank first, nth_element reorders the array
+        result.m_maxLatency = *std::max_element(latency.begin(), latency.end());
+        int rank99 = static_cast<long long>(numCommand - 1) * 99 / 100;
+        std::nth_element(latency.begin(), latency.begin() + rank99, latency.end());
+        result.m_p99Latency = latency[rank99];
+        std::nth_element(latency.begin(), latency.begin() + (numCommand - 1) / 2, latency.end());
+        result.m_p50Latency = latency[(numCommand - 1) / 2];
+    }
+    return result;
+}
@@ -1,29 +1,122 @@
+#ifndef FTL_H
+#define FTL_H
+
 #include <cassert>
 #include <cstring>
 #include <ctime>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <list>
 #include <map>
+#include <mutex>
 #include <random>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "trace.h"
+
 
 class Executor;
+class BlockData;
+class TelemetryWriter;
+struct ProfileRun;
+// ============== CounterRandom ====================
+
+/**
+ * @brief Philox4x32-10 counter-based generator, the stream is fully defined
+ *        by (seed, stream, epoch), so blocks can draw numbers in parallel
+ *        and stay reproducible
+ */
+class CounterRandom {
+public:
+    explicit CounterRandom(uint64_t seed, uint32_t stream, uint32_t epoch);
+
+    uint32_t next();
+    /**
+     * @brief uniformInt : [0, bound)
+     */
+    int uniformInt(int bound);
+    /**
+     * @brief uniformReal : [0, 1)
+     */
+    double uniformReal();
+private:
+    void generate();
+
+    uint32_t m_key[2];
+    uint32_t m_counter[4];
+    uint32_t m_result[4];
+    int m_resultIndex;
+};
+
+/**
+ * @brief defaultSeed : seed of a run configured with 0, the FTL_SEED of the
+ *                      build, the wall clock if that is 0 too
+ */
+uint64_t defaultSeed();
+
+// ============== DataContext ====================
+
+/**
+ * @brief geometry shared by the pages & blocks of one SSD instance,
+ *        owned by the SSD so several simulations can live in one process
+ */
+struct DataContext {
+    bool m_isRealData;
+    int m_bytePerPage;
+    int m_pagePerBlock;
+    int m_eccNumBit;
+    int m_pageShift; // log2 of m_pagePerBlock, -1 if not a power of two
+};
+
+// ============== Geometry ====================
+
+/**
+ * @brief block geometry of the dissipation kernel, a power-of-two
+ *        geometry is a compile-time constant and folds into shifts
+ */
+template <int BLOCK_SHIFT, int LINE_SHIFT, int LEVEL_SHIFT>
+struct Pow2Geometry {
+    int blockPerLine() const { return 1 << BLOCK_SHIFT; }
+    int linePerLevel() const { return 1 << LINE_SHIFT; }
+    int levelPerChip() const { return 1 << LEVEL_SHIFT; }
+    int linear(int x, int y, int z) const {
+        return (((z << LINE_SHIFT) | y) << BLOCK_SHIFT) | x;
+    }
+};
+
+/**
+ * @brief fallback of any other geometry
+ */
+struct GenericGeometry {
+    GenericGeometry(int blockPerLine, int linePerLevel, int levelPerChip) :
+        m_blockPerLine(blockPerLine), m_linePerLevel(linePerLevel),
+        m_levelPerChip(levelPerChip) {}
+
+    int blockPerLine() const { return m_blockPerLine; }
+    int linePerLevel() const { return m_linePerLevel; }
+    int levelPerChip() const { return m_levelPerChip; }
+    int linear(int x, int y, int z) const {
+        return (z * m_linePerLevel + y) * m_blockPerLine + x;
+    }
+
+    int m_blockPerLine,
+        m_linePerLevel,
+        m_levelPerChip;
+};
+
 // ============== PageData ====================
 
 class PageData {
 public:
-    static bool m_isRealData; //= false;
-    static int m_bytePerPage; // = 4096;
-
-public:
-
-    explicit PageData();
+    explicit PageData(const DataContext *context);
     ~PageData();
 
     void clearData();
@@ -34,6 +127,21 @@ public:
     bool getDataAsErrCount(int &notRealData);
     bool setDataAsBit(const char *realPageData);
     bool setDataAsErrCount(int notRealData);
+    /**
+     * @brief flipBit : inject one bit error into real data
+     */
+    bool flipBit(int bitIndex);
+    /**
+     * @brief getErrCount : error bits of the page in both data modes,
+     *                      the written payload is all zero
+     */
+    int getErrCount();
+    /**
+     * @brief correctData : drop the error bits, the data keeps programmed
+     */
+    void correctData();
+
+    void setOwner(BlockData *block);
 
     void setValid(bool isValid);
     bool getValid();
@@ -44,8 +152,18 @@ public:
     bool setRealPageNum(int pageNum);
     int getRealPageNum();
 private:
-    char *m_realPageData;
+    void setErrCount(int errCount);
+    void reserveFlipBit(int numFlip);
+
+    const DataContext *m_context;
+
+    // real data is stored sparse: the sorted offsets of the bits set to 1,
+    // the full bytes are only built by getDataAsBit
+    int *m_flipBit;
+    bool m_hasRealData;
     int m_notRealPageData; // only store amount of error per page
+    int m_errBitCount; // number of m_flipBit
+    BlockData *m_block; // owner, keeps the block error totals
 
     bool m_isValid;
     bool m_isFree;
@@ -55,10 +173,7 @@ private:
 // ============== BlockData ====================
 class BlockData {
 public:
-    static int m_pagePerBlock; // = 0;
-
-public:
-    explicit BlockData();
+    explicit BlockData(const DataContext *context);
     ~BlockData();
 
     void clearData();
@@ -77,21 +192,83 @@ public:
 
     void setIsFree(bool isFree);
     bool getIsFree();
+
+    /**
+     * @brief markProgram : keep the time of the first program after erase,
+     *                      retention age counts from it
+     */
+    void markProgram(double time);
+    double getProgramTime();
+
+    /**
+     * @brief expected errors accrued since the last settlement,
+     *        only a programmed block accrues
+     */
+    void setErrDose(double errDose, double doseTime);
+    double getErrDose();
+    double getDoseTime();
+    uint32_t nextSettleEpoch();
+
+    /**
+     * @brief running error totals, updated by the pages
+     */
+    void updateErrCount(int oldCount, int newCount);
+    long long getErrCount();
+    long long getErrOverEcc();
 private:
+    const DataContext *m_context;
     PageData **m_pageData;
 
+    long long m_errCount,
+            m_errOverEcc; // errors of pages beyond the ECC limit
+
     double m_temper;
     int m_eraseCount;
     bool m_isFree;
+    double m_programTime; // -1 : erased
+
+    double m_errDose,
+            m_doseTime;
+    uint32_t m_settleEpoch;
 };
 
 // ============== SSD ====================
 
+// physical flash operations, index into SSD::m_flashOp; the order is
+// the order their times are summed in
+enum FlashOpIndex {
+    FLASHOP_READOOB,
+    FLASHOP_WRITEOOB,
+    FLASHOP_READPAGE,
+    FLASHOP_PROGRAM,
+    FLASHOP_ERASE,
+    NUMFLASHOP
+};
+
+// or-ed into the mask of SSD::chargeFlash
+enum FlashOp {
+    FLASH_READOOB = 1 << FLASHOP_READOOB,
+    FLASH_WRITEOOB = 1 << FLASHOP_WRITEOOB,
+    FLASH_READPAGE = 1 << FLASHOP_READPAGE,
+    FLASH_PROGRAM = 1 << FLASHOP_PROGRAM,
+    FLASH_ERASE = 1 << FLASHOP_ERASE
+};
+
+// what the flash operations are done for
+enum OpCause {
+    OPCAUSE_HOST,
+    OPCAUSE_GC, // gc & merges
+    OPCAUSE_BACKGROUND, // hotspot migration & scrubbing
+    NUMOPCAUSE
+};
+
 class SSD {
 public:
-    static int m_logicBlock; // = 0
-    static int m_physicBlock; // = 0
-    static int m_minimumFreeBlock; // =0
+    int m_logicBlock;
+    int m_physicBlock;
+    int m_minimumFreeBlock;
+
+    DataContext m_dataContext;
 
 public:
     explicit SSD();
@@ -142,8 +319,54 @@ public:
 
     bool linear2threeDimesion(int linear, int &x, int &y, int &z);
     bool threeDimension2linear(int x, int y, int z, int &linear);
+    /**
+     * @brief logic page number to logic block & page offset,
+     *        shift & mask when pagePerBlock is a power of two
+     */
+    int logicBlockOf(int logicNum);
+    int logicPageOf(int logicNum);
+
+    /**
+     * @brief write heat of logic blocks, decayed at every dissipation
+     */
+    void decayHeat();
+    bool isHotLogicBlock(int logicBlock);
+    /**
+     * @brief pickDissipateBlock : the free block dissipating heat best,
+     *                             the coolest one wins a tie
+     */
+    std::list<int>::iterator pickDissipateBlock();
+    std::list<int>::iterator pickCoolBlock();
+
+    /**
+     * @brief mergeChain : move all valid pages of a logic block's chain into
+     *                     targetBlock and erase the chain, same cost as gc
+     * @param refresh : the pages are ECC corrected before written back
+     * @return number of pages moved
+     */
+    int mergeChain(int logicBlock, int targetBlock, bool refresh = false);
+    /**
+     * @brief relocateBlock : move the valid pages of one physical block and
+     *                        erase it, for the FTLs without block chains
+     * @return number of pages moved, -1 : relocate the logic block's chain
+     */
+    virtual int relocateBlock(int phyBlock, bool refresh);
+    /**
+     * @brief chainLength : physical blocks holding the data of a logic block
+     */
+    virtual int chainLength(int logicBlock);
+
+    /**
+     * @brief chargeFlash : count the operations of the mask for m_opCause
+     *                      and charge their time to the clock
+     */
+    void chargeFlash(int opMask);
+    void countFlash(int opMask);
+    double flashTime(int opMask);
 
 private:
+    void initDissipateScore();
+
     bool loadLevelBlockData(std::ifstream &inStream, int levelIndex);
     bool writeLevelBlockData(std::ofstream &outStream, int levelIndex);
 
@@ -155,6 +378,27 @@ public:
         *m_replaceTable;
 
     std::list<int> m_freeBlock;
+
+    // heat-dissipation-aware placement
+    std::vector<double> m_logicHeat;
+    double m_logicHeatSum;
+    std::vector<double> m_dissipateScore; // thermal conductance to the boundary
+    int m_allocLogicBlock; // logic block being written, -1 otherwise
+    long long m_hotAllocCount;
+
+    long long m_hostWrite; // pages written by the host
+
+    // physical operations by cause
+    int m_opCause;
+    long long m_flashOp[NUMOPCAUSE][NUMFLASHOP];
+
+    // gc merge mix
+    long long m_gcCount, // gc runs & merges
+            m_switchMerge, // log block turned into the data block, no copy
+            m_partialMerge, // only the missing pages copied
+            m_fullMerge, // every valid page copied into a new block
+            m_gcCopyPage;
+    double m_gcTime;
 };
 
 // =============== SSD_1 ===================
@@ -175,6 +419,8 @@ public:
      * @brief only used for writepage operation
      */
     virtual bool findfreePage(int logicNum, int &phyBlock, int &phyPage);
+private:
+    int m_gcLogicBlock; // cursor of the round robin victim search
 };
 
 // =============== SSD_2 ===================
@@ -185,37 +431,257 @@ public:
 
     virtual bool initFreeBlockList(std::string filename);
     virtual int findfree();
+private:
+    std::default_random_engine m_generator; // seeded from the run's seed
+};
+
+// =============== SSD_3 ===================
+/**
+ * @brief page-mapped log-structured FTL: a flat logic page -> physical page
+ *        map, writes append to the active block of their stream, greedy gc
+ *        collects the block with the fewest valid pages;
+ *        entryTable & replaceTable stay empty
+ */
+class SSD_3 : public SSD {
+public:
+    explicit SSD_3();
+    virtual ~SSD_3();
+
+    virtual bool initFreeBlockList(std::string filename);
+    virtual int findfree();
+    /**
+     * @brief gc : collect the victim of the fewest valid pages
+     * @return false if no block can be collected
+     */
+    virtual bool gc(std::vector<int> &gcChain, int pageNum);
+    virtual bool logic2physic(int logicNum, int &phyBlock, int &phyPage);
+    virtual bool findfreePage(int logicNum, int &phyBlock, int &phyPage);
+    virtual int relocateBlock(int phyBlock, bool refresh);
+    virtual int chainLength(int logicBlock);
+private:
+    enum {
+        STREAM_HOST,
+        STREAM_GC, // relocated pages, colder than the host writes
+        NUMSTREAM
+    };
+
+    /**
+     * @brief nextPage : append point of the stream, a full active block is
+     *                   replaced, host writes keep the gc reserve
+     */
+    bool nextPage(int stream, int &phyBlock, int &phyPage);
+    int pickVictim();
+    /**
+     * @return pages moved, -1 if the free space can't hold them
+     */
+    int relocate(int phyBlock, bool refresh);
+
+    std::vector<int> m_pageMap, // logic page -> physical page, -1 : unmapped
+            m_pageOwner, // physical page -> logic page, -1 : not valid
+            m_validCount; // valid pages per block
+    int m_activeBlock[NUMSTREAM],
+        m_activePage[NUMSTREAM]; // next page to program
+};
+
+// =============== SSD_4 ===================
+/**
+ * @brief hybrid log-block FTL: block-mapped data blocks (entryTable) plus
+ *        a sequential log block owned by one logic block and a FIFO pool of
+ *        random log blocks shared by all logic blocks; a full sequential
+ *        log block is switched into the data block, a partial one gets its
+ *        missing pages copied, a reclaimed random log block needs a full
+ *        merge of every logic block having pages in it
+ */
+class SSD_4 : public SSD {
+public:
+    explicit SSD_4();
+    virtual ~SSD_4();
+
+    virtual bool initFreeBlockList(std::string filename);
+    virtual int findfree();
+    /**
+     * @brief gc : reclaim the oldest random log block
+     * @return false if there is none
+     */
+    virtual bool gc(std::vector<int> &gcChain, int pageNum);
+    virtual bool logic2physic(int logicNum, int &phyBlock, int &phyPage);
+    virtual bool findfreePage(int logicNum, int &phyBlock, int &phyPage);
+    virtual int chainLength(int logicBlock);
+    /**
+     * @brief relocateBlock : the log blocks, which no chain holds; a random
+     *                        log is reclaimed as by gc, the sequential log
+     *                        is fully merged into a cool block
+     */
+    virtual int relocateBlock(int phyBlock, bool refresh);
+private:
+    /**
+     * @brief closeSeqLog : switch | partial merge of the sequential log block
+     */
+    void closeSeqLog();
+    /**
+     * @brief fullMerge : newest copy of every page into a new data block
+     * @return number of pages moved
+     */
+    int fullMerge(int logicBlock, bool refresh = false);
+    /**
+     * @brief reclaimRandLog : full merge of every logic block having a valid
+     *                         page in the random log block, then erase it
+     * @return number of pages moved
+     */
+    int reclaimRandLog(int victim, bool refresh);
+    void movePage(int srcBlock, int srcPage, int targetBlock, int targetPage, bool refresh = false);
+    void eraseBlock(int phyBlock);
+    int takeCoolBlock();
+
+    std::vector<int> m_logMap, // logic page -> physical page in a log block, -1 : in the data block
+            m_logOwner; // physical page of a log block -> logic page, -1 : not valid
+    int m_seqLogBlock,
+        m_seqLogicBlock,
+        m_seqNextPage; // page offset expected next
+    std::deque<int> m_randLog; // oldest first, the back takes the writes
+    int m_randNextPage,
+        m_maxRandLog;
 };
 
+/**
+ * @brief createSSD : FTL of the method number, NULL if unknown
+ */
+SSD *createSSD(const std::string &methodNum);
+
 // =============== Executor=================
 class Executor {
 public:
     explicit Executor();
     ~Executor();
+private:
+    // owns m_telemetry, a partition reads the config file again instead
+    Executor(const Executor &);
+    Executor &operator=(const Executor &);
 
 public:
     bool readConfigFile(std::string configFileName);
 
     bool initData();
     void setSSD(SSD *ssd);
+    /**
+     * @brief setTraceFile : replace the trace list of the config file
+     */
+    void setTraceFile(const std::string &traceFile);
+    /**
+     * @brief redirectOutput : write back state & statistic files as
+     *                         prefix + basename (dir + prefix + basename
+     *                         with keepDir), call after initData
+     */
+    void redirectOutput(const std::string &prefix, bool keepDir = false);
+    /**
+     * @brief snapshot : write back the state & summary as prefix + basename
+     *                   in the middle of a run
+     */
+    bool snapshot(const std::string &prefix);
 
     bool beginProcess();
     bool endProcess();
 
     void checkTime(double time);
     void checkTemper(int blockIndex, double temper);
+    /**
+     * @brief throttle : delay the access of an overheated block
+     *                   (or level), the delay is charged to the clock
+     */
+    void throttle(int blockIndex);
+    double throttleTemper(int blockIndex);
+    /**
+     * @brief decodeRead : hard decode, soft decode then read-retry levels,
+     *                     the first one able to correct errCount wins
+     * @return decode level, -1 if uncorrectable
+     */
+    int decodeRead(int blockIndex, int errCount);
+    /**
+     * @brief decodePage : the time & heat of decodeRead without the read
+     *                     statistic, for the patrol reads of scrub
+     */
+    int decodePage(int blockIndex, int errCount);
+    /**
+     * @brief deepestDecodeBit : most errors a page may hold and still be
+     *                           read back correct
+     */
+    int deepestDecodeBit();
+    void recordReadLatency(double latency);
 
 public:
     void disspateTemper();
+    /**
+     * @brief dissipateKernel : the exchange passes of disspateTemper,
+     *        instantiated for the common geometries, no bounds checks
+     */
+    template <class Geometry>
+    void dissipateKernel(const Geometry &geometry);
     void releaseTemper(int neighborPre, int phyBlock,
                        int neighborNext, double percent);
+    /**
+     * @brief ghostBlock : index standing for the block of a neighbor
+     *                     partition next to the edge level, -1 if none
+     */
+    int ghostBlock(int blockIndex, int lineIndex, bool isNext);
     void statisticTemper();
 
+    /**
+     * @brief migrateHotspot : background task, moves the data of sustained
+     *                         hotspots into cool free blocks
+     */
+    void migrateHotspot();
+    /**
+     * @brief scrub : patrol blocks within the page budget, refresh the data
+     *                of a block whose worst page nears the ECC limit
+     */
+    void scrub();
+    void runBackgroundTask();
+    /**
+     * @brief sampleTelemetry : one row of drive state into
+     *                          summaryFile_telemetry, see telemetry.h
+     */
+    void sampleTelemetry();
+
     void injectErr();
-    void createErrForBlock(int blockIndex, int errCount);
+    /**
+     * @brief errCountOfTemper : errors per interval of the highest stage
+     *                           below the temperature
+     */
+    int errCountOfTemper(double temper);
+    /**
+     * @brief evalErrRate : expected errors per interval of every block in
+     *                      [startBlock, endBlock), from temperature,
+     *                      P/E cycles and retention age in one pass
+     */
+    void evalErrRate(int startBlock, int endBlock, double *errRate);
+    double errRateOfBlock(int blockIndex);
+    long long injectErrRange(int startBlock, int endBlock);
+    /**
+     * @brief lazy error model, accrueErr integrates the error rate up to now
+     *        and must run before the temperature of a block changes;
+     *        settleErr turns the accrued dose into errors and counts them
+     *        in m_injectErrCount
+     * @return number of errors injected
+     */
+    void accrueErr(int blockIndex);
+    int settleErr(int blockIndex);
+    void settleAllErr();
+    /**
+     * @brief settleErrUncounted : settleErr without m_injectErrCount,
+     *                             safe on the worker threads of settleAllErr
+     */
+    int settleErrUncounted(int blockIndex);
+    /**
+     * @return number of errors injected
+     */
+    int createErrForBlock(int blockIndex, int errCount, CounterRandom &random);
     void statisticErr();
 
-    bool processRequest(std::ifstream &inStream);
+    bool processRequest(TraceReader &traceReader);
+    /**
+     * @return physical block of the page, -1 if nothing was accessed
+     */
+    int executeRequest(bool isWrite, int logicNum, PageData &pageData);
 public:
 
     // stucture of SSD
@@ -257,7 +723,61 @@ public:
         m_calErrInterval;
 
     std::map<double, int> m_temper2numBlockErr;
+    std::vector<double> m_errTemperStage; // sorted keys of m_temper2numBlockErr
+    std::vector<int> m_errCountStage;
     int m_eccNumBit;
+
+    // wear & retention factors of the error rate
+    // rate *= 1 + wearCoef * (eraseCount / wearScale) ^ wearExponent
+    // rate *= 1 + retentionCoef * ln(1 + age / retentionScale)
+    double m_wearCoef,
+            m_wearScale,
+            m_wearExponent,
+            m_retentionCoef,
+            m_retentionScale;
+    // errors settle when a block is read, moved, counted or written back,
+    // instead of the periodic whole-chip injection
+    bool m_lazyErr;
+
+    // random seed of the error model & worker threads
+    uint64_t m_randomSeed;
+    int m_numThread;
+
+    // dynamic thermal management
+    int m_throttleScope; // 0 : block, 1 : level
+    std::vector<double> m_throttleTemper,
+                        m_throttleDelay; // extra time per access
+    double m_throttleHaltTemper;
+    int m_throttleMaxStall;
+
+    // read path, hard decode corrects up to m_eccNumBit
+    double m_hardDecodeTime,
+            m_hardDecodeTemper;
+    int m_softEccNumBit;
+    double m_softDecodeTime,
+            m_softDecodeTemper;
+    std::vector<int> m_retryEccNumBit; // each retry re-reads the page
+    std::vector<double> m_retryTime,
+                        m_retryTemper;
+
+    // heat-dissipation-aware placement
+    bool m_heatAwarePlacement;
+    double m_hotHeatFactor, // hot if heat >= factor * average heat
+            m_heatDecay;
+
+    // hotspot migration
+    int m_migrateInterval; // 0 : disabled
+    double m_hotspotTemper;
+    int m_hotspotRound, // consecutive scans over hotspotTemper
+        m_migrateBudget; // pages per scan
+
+    // scrubbing
+    int m_scrubInterval, // 0 : disabled
+        m_scrubBudget; // patrol page reads per run
+    double m_scrubThreshold; // refresh at worst page >= threshold * m_eccNumBit
+
+    // drive state time series
+    int m_telemetryInterval; // 0 : disabled
     // -------------------------------------------
     // input file
     std::vector<std::string> m_traceFileNameList;
@@ -268,6 +788,17 @@ public:
     std::string m_freeBlockListFile;
 
 
+    // print every request & gc to stdout
+    bool m_verbose;
+
+    // partitioned run: dissipation waits for the barrier, the edge levels
+    // of the neighbor partitions are copied into m_ghostTemper
+    // (level above, then level below)
+    bool m_barrierDissipate,
+            m_hasGhostPre,
+            m_hasGhostNext;
+    std::vector<double> m_ghostTemper;
+
     // output filename
     std::string m_temperShotPrefix; // prefix_times_level
     std::string m_errorFilename;
@@ -276,12 +807,191 @@ public:
     // -------------------------------------------
     SSD *m_ssd;
 
+    // simulated clock
+    double m_simulateTime;
+    long long m_requestCount;
+
+    // throttle statistic
+    long long m_throttleEvent,
+            m_throttleStall;
+    double m_throttleTime;
+    std::vector<double> m_levelMaxTemper; // sampled after dissipation
+    double m_peakTemper;
+
+    // hotspot migration statistic
+    std::vector<int> m_hotStreak;
+    long long m_migrateChain,
+            m_migratePage,
+            m_migrateErase;
+
+    // scrubbing statistic
+    int m_scrubCursor,
+            m_scrubPageCursor, // page the cut short block resumes from
+            m_scrubEraseCount, // erase count of that block when it was cut
+            m_scrubWorstErr;   // worst decodable errCount patrolled so far
+    long long m_scrubRun,
+            m_scrubPageRead,
+            m_scrubRefreshChain,
+            m_scrubRefreshPage,
+            m_scrubRefreshErase,
+            m_scrubNearEccPage, // refreshed before passing the ECC limit
+            m_scrubOverEccPage, // past the ECC limit, soft decode or retry corrects it
+            m_scrubLostPage; // past the deepest decode level, moved as it is
+    double m_scrubBusyTime;
+
+    // error statistic
+    long long m_injectErrCount;
+    uint32_t m_injectEpoch;
+
+    // read path statistic
+    std::vector<long long> m_decodeLevelCount; // hard, soft, retry 1..n
+    long long m_uncorrectableRead,
+            m_readCount;
+    double m_readLatencySum,
+            m_readLatencyMax;
+    std::vector<long long> m_readLatencyHist; // log2 of latency / readPageTime
+
+    // opened by the first sample, a configuration copied into the
+    // partitions never holds one
+    TelemetryWriter *m_telemetry;
+    // profile counters of the run, created by beginProcess; the partitions
+    // count into the one of their PartitionExecutor
+    ProfileRun *m_profileRun;
+
 private:
     // time ticker
     double m_dissipateTemperTime,
             m_statisticTemperTime,
             m_injectErrTime,
-            m_statisticErrTime;
+            m_statisticErrTime,
+            m_migrateTime,
+            m_scrubTime,
+            m_telemetryTime;
+    bool m_migratePending,
+            m_scrubPending,
+            m_telemetryPending;
+
+    int m_shotCount;
 };
 
+// =============== PartitionExecutor =================
+/**
+ * @brief level-partitioned simulation, one worker thread per partition
+ *
+ * Partition p owns the levels [p * L / P, (p + 1) * L / P) and the logic
+ * blocks b with b % P == p (local logic block b / P). It is a complete
+ * Executor & SSD with its own clock, free pool and tables, its files are
+ * written as part<p>_<name> next to the configured ones.
+ *
+ * The partitions meet at a barrier every dissTemperInterval of simulated
+ * time. The result equals this serial order, whatever the thread timing:
+ *   for k = 1, 2, ... :
+ *     for p = 0 .. P-1 : run the requests of p in trace order
+ *                        while its clock < k * dissTemperInterval
+ *     a partition out of requests at the trace end idles to the boundary
+ *     copy the edge levels of every partition into the ghosts of its
+ *     neighbors, then every partition dissipates its levels
+ */
+class PartitionExecutor {
+public:
+    explicit PartitionExecutor();
+    ~PartitionExecutor();
+
+    bool init(std::string configFileName, std::string methodNum, int numPartition);
+
+    bool beginProcess();
+    bool endProcess();
+private:
+    struct Request {
+        int logicNum; // local to the partition
+        bool isWrite;
+    };
+
+    /**
+     * @brief refill : route the next chunk of the traces to the partitions
+     * @return false on a broken trace line
+     */
+    bool refill();
+    /**
+     * @brief endRound : serial step at the barrier, decides the next round
+     */
+    void endRound();
+    void exchangeGhost();
+    void arriveBarrier();
+    void runPartition(int partIndex);
+    bool writeBackSummary();
+
+    Executor m_config; // configuration of the whole chip
+    int m_numPartition;
+    std::vector<Executor*> m_executor;
+    std::vector<SSD*> m_ssd;
+
+    // requests waiting in each partition, consumed from the cursor
+    std::vector<std::vector<Request> > m_queue;
+    std::vector<size_t> m_cursor;
+    int m_traceIndex;
+    TraceReader m_traceReader;
+    bool m_traceEnd,
+            m_traceFail;
+
+    // barrier, the last thread to arrive runs endRound
+    std::mutex m_mutex;
+    std::condition_variable m_roundCond;
+    int m_arriveCount;
+
+    double m_boundary; // clock of the next barrier
+    bool m_dissipate, // partitions dissipate after the barrier
+            m_finish;
+    long long m_roundCount, // barrier rounds, refills included
+            m_epochCount;
+    ProfileRun *m_profileRun; // profile counters of every partition
+};
+
+// =============== HostQueue =================
+struct HostCommand {
+    int m_unit; // -1 : answered without flash access
+    double m_serviceTime;
+    bool m_isWrite;
+};
+
+struct QueueDepthResult {
+    int m_queueDepth;
+    long long m_numCommand;
+    double m_makespan,
+            m_iops, // commands per 1000 time units (ms in configFile.txt)
+            m_avgLatency,
+            m_p50Latency,
+            m_p99Latency,
+            m_maxLatency,
+            m_avgReadLatency,
+            m_avgWriteLatency,
+            m_unitBusy; // average utilization of the flash units
+};
+
+/**
+ * @brief NVMe-style host interface timing model
+ *
+ * record runs the trace through the FTL once, in trace order; a command
+ * keeps its flash unit (a range of physical blocks, one level by default)
+ * and the simulated time it took, gc & background tasks included.
+ * replay plays the commands through numQueue submission/completion queue
+ * pairs of queueDepth entries: command i belongs to queue i % numQueue,
+ * a queue submits its next command when one of its own completes, the
+ * commands waiting for a unit are dispatched oldest first when it turns
+ * idle and complete out of order across units.
+ */
+class HostQueue {
+public:
+    explicit HostQueue(int numQueue, int numUnit);
+
+    bool record(Executor *executor, TraceReader &traceReader);
+    QueueDepthResult replay(int queueDepth);
+
+    long long getNumCommand();
+private:
+    int m_numQueue,
+        m_numUnit;
+    std::vector<HostCommand> m_command;
+};
 
+#endif // FTL_H
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""End-to-end harness: runs the cases of harness/cases, records wall time,
+requests/s & peak RSS of every run and compares every file it writes with
+harness/golden/<case>.
+
+usage: harness.py --ftl PATH --tracegenerator PATH --traceimport PATH --work DIR [--update]
+
+--update replaces the golden files with the outputs of this run.
+work/report: case wallTime(s) requests requests/s peakRSS(KB) numFile status
+"""
+
+import argparse
+import filecmp
+import os
+import shutil
+import subprocess
+import struct
+import sys
+import time
+
+HARNESS_DIR = os.path.dirname(os.path.abspath(__file__))
+GOLDEN_DIR = os.path.join(HARNESS_DIR, "golden")
+STDOUT_NAME = "stdout"  # request log of the run, not compared
+
+
+def run_child(argv, cwd, stdout_path):
+    """returns (exit status, wall time, peak RSS in KB) of one process"""
+    with open(stdout_path, "w") as out_file:
+        begin = time.monotonic()
+        child = subprocess.Popen(argv, cwd=cwd, stdout=out_file)
+        _, status, usage = os.wait4(child.pid, 0)
+        wall_time = time.monotonic() - begin
+    child.returncode = os.waitstatus_to_exitcode(status)
+    return child.returncode, wall_time, usage.ru_maxrss
+
+
+def read_cases():
+    trace_list, import_list, run_list = [], [], []
+    with open(os.path.join(HARNESS_DIR, "cases")) as case_file:
+        for line_num, line in enumerate(case_file, 1):
+            field = line.split()
+            if not field or field[0].startswith("#"):
+                continue
+            if field[0] == "trace" and len(field) == 4:
+                trace_list.append(field[1:])
+            elif field[0] == "import" and len(field) == 5:
+                import_list.append(field[1:])
+            elif field[0] == "run" and len(field) >= 6:
+                run_list.append(field[1:])
+            else:
+                sys.exit("Wrong case line %d: %s" % (line_num, line.strip()))
+    return trace_list, import_list, run_list
+
+
+def count_requests(trace_path):
+    """page requests of a trace, binary (see trace.h) or text"""
+    with open(trace_path, "rb") as trace_file:
+        header = trace_file.read(24)
+        if len(header) == 24 and header[:8] == b"FTLTRACE":
+            return struct.unpack("<Q", header[16:24])[0]
+        trace_file.seek(0)
+        return sum(1 for line in trace_file if line.strip())
+
+
+def output_files(case_dir):
+    return sorted(name for name in os.listdir(case_dir)
+                  if name != STDOUT_NAME and os.path.isfile(os.path.join(case_dir, name)))
+
+
+def compare(case_name, case_dir):
+    """returns the list of differences against the golden files"""
+    golden_dir = os.path.join(GOLDEN_DIR, case_name)
+    if not os.path.isdir(golden_dir):
+        return ["no golden"]
+    produced, golden = output_files(case_dir), output_files(golden_dir)
+    diff_list = ["missing " + name for name in sorted(set(golden) - set(produced))]
+    diff_list += ["extra " + name for name in sorted(set(produced) - set(golden))]
+    for name in sorted(set(golden) & set(produced)):
+        if not filecmp.cmp(os.path.join(case_dir, name), os.path.join(golden_dir, name), shallow=False):
+            diff_list.append("differs " + name)
+    return diff_list
+
+
+def finish_case(name, case_dir, status, wall_time, peak_rss, num_request, update):
+    """compares or updates the golden files of a case, returns (report line, is ok)"""
+    if status != 0:
+        result = "FAIL exit %d" % status
+    elif update:
+        golden_dir = os.path.join(GOLDEN_DIR, name)
+        shutil.rmtree(golden_dir, ignore_errors=True)
+        os.makedirs(golden_dir)
+        for file_name in output_files(case_dir):
+            shutil.copy(os.path.join(case_dir, file_name), golden_dir)
+        result = "updated"
+    else:
+        diff_list = compare(name, case_dir)
+        result = "ok" if not diff_list else "DIFF " + ", ".join(diff_list)
+
+    report_line = "%s\t%.3f\t%d\t%.0f\t%d\t%d\t%s" % (
+        name, wall_time, num_request, num_request / wall_time if wall_time > 0 else 0,
+        peak_rss, len(output_files(case_dir)), result)
+    return report_line, result in ("ok", "updated")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--ftl", required=True)
+    parser.add_argument("--tracegenerator", required=True)
+    parser.add_argument("--traceimport", required=True)
+    parser.add_argument("--work", required=True)
+    parser.add_argument("--update", action="store_true")
+    args = parser.parse_args()
+
+    trace_list, import_list, run_list = read_cases()
+    work_dir = os.path.abspath(args.work)
+    trace_dir = os.path.join(work_dir, "traces")
+    os.makedirs(trace_dir, exist_ok=True)
+
+    # 0, traces, fixed seeds
+    for name, spec_file, seed in trace_list:
+        argv = [args.tracegenerator, os.path.join(HARNESS_DIR, spec_file),
+                os.path.join(trace_dir, name), seed]
+        if subprocess.call(argv, stdout=subprocess.DEVNULL) != 0:
+            sys.exit("Fail generate trace " + name)
+
+    # 1, imports, compared as cases of their own and usable by the runs
+    report_lines, num_fail = [], 0
+    for name, trace_format, config_file, input_file in import_list:
+        case_dir = os.path.join(work_dir, name)
+        shutil.rmtree(case_dir, ignore_errors=True)
+        os.makedirs(case_dir)
+
+        trace_path = os.path.join(case_dir, "trace")
+        argv = [args.traceimport, trace_format, os.path.join(HARNESS_DIR, config_file),
+                os.path.join(HARNESS_DIR, input_file), trace_path]
+        status, wall_time, peak_rss = run_child(argv, case_dir, os.path.join(case_dir, STDOUT_NAME))
+        num_request = count_requests(trace_path) if status == 0 else 0
+        if status == 0:
+            shutil.copy(trace_path, os.path.join(trace_dir, name))
+
+        report_line, is_ok = finish_case(name, case_dir, status, wall_time, peak_rss, num_request, args.update)
+        report_lines.append(report_line)
+        num_fail += 0 if is_ok else 1
+        print(report_line, flush=True)
+
+    # 2, runs
+    for case in run_list:
+        name, method, config_file, num_partition, traces = case[0], case[1], case[2], case[3], case[4:]
+        case_dir = os.path.join(work_dir, name)
+        shutil.rmtree(case_dir, ignore_errors=True)
+        os.makedirs(case_dir)
+
+        argv = [args.ftl, os.path.join(HARNESS_DIR, config_file), method]
+        if int(num_partition) > 1:
+            argv.append(num_partition)
+        status, wall_time, peak_rss = run_child(argv, case_dir, os.path.join(case_dir, STDOUT_NAME))
+
+        num_request = 0
+        for trace in traces:
+            num_request += count_requests(os.path.join(trace_dir, trace))
+
+        report_line, is_ok = finish_case(name, case_dir, status, wall_time, peak_rss, num_request, args.update)
+        report_lines.append(report_line)
+        num_fail += 0 if is_ok else 1
+        print(report_line, flush=True)
+
+    with open(os.path.join(work_dir, "report"), "w") as report_file:
+        report_file.write("case\twallTime(s)\trequests\trequests/s\tpeakRSS(KB)\tnumFile\tstatus\n")
+        report_file.write("\n".join(report_lines) + "\n")
+
+    num_case = len(import_list) + len(run_list)
+    print("%d/%d cases ok" % (num_case - num_fail, num_case))
+    return 0 if num_fail == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
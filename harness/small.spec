@@ -0,0 +1,10 @@
+small.cfg
+6000
+2
+exponential 2
+3  1 4  4 2  8 1
+4
+1 0.3 zipf 0.9
+1 0.5 hotspot 0.9 0.1 0.8
+1 0 sequential 32
+0.5 0.5 uniform
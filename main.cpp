@@ -3,21 +3,28 @@
 
 
 int main(int argc, char *argv[]) {
-    if (argc <= 1 || argc > 3) {
+    if (argc <= 2 || argc > 4) {
         std::cerr << "Wrong num of argument !!!" << std::endl;
         return 1;
     }
 
     std::string configFile(argv[1]);
     std::string methodNum(argv[2]);
+    int numPartition = argc > 3 ? atoi(argv[3]) : 1;
+
+    // level-partitioned run, one thread per partition
+    if (numPartition > 1) {
+        PartitionExecutor *partExecutor = new PartitionExecutor;
+        if (partExecutor->init(configFile, methodNum, numPartition) == false) return 1;
+        std::cout << "init over \n";
+        if (partExecutor->beginProcess() == false) return 1;
+        partExecutor->endProcess();
+        delete partExecutor;
+        return 0;
+    }
 
-    SSD *ssdPtr = NULL;
-
-    if (methodNum == std::string("1")) {
-        ssdPtr = new SSD_1;
-    } else if (methodNum == std::string("2")) {
-        ssdPtr = new SSD_2;
-    } else {
+    SSD *ssdPtr = createSSD(methodNum);
+    if (ssdPtr == NULL) {
         std::cerr << "Wrong method number !!!" << std::endl;
         return 1;
     }
@@ -30,7 +37,7 @@ int main(int argc, char *argv[]) {
     std::cout << "allocate over \n";
     executor->initData();
     std::cout << "init over \n";
-    executor->beginProcess();
+    if (executor->beginProcess() == false) return 1;
     executor->endProcess();
 
     return 0;
@@ -0,0 +1,135 @@
+#include "profile.h"
+
+#ifdef FTL_PROFILE
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+static const char *PROFILE_SCOPE_NAME[NUMPROFILESCOPE] = {
+    "readPage",
+    "writePage",
+    "findfreePage",
+    "findfree",
+    "gc",
+    "checkTime",
+    "disspateTemper",
+    "injectErr",
+    "statisticErr",
+    "statisticTemper"
+};
+
+thread_local ProfileRun *t_profileRun = NULL;
+thread_local ProfileThread *t_profileThread = NULL;
+
+struct ProfileRun {
+    std::mutex m_mutex;
+    std::vector<ProfileThread*> m_thread;
+    // tick -> ns calibration, from the creation to the write
+    uint64_t m_beginTick;
+    std::chrono::steady_clock::time_point m_beginTime;
+};
+
+ProfileRun *createProfileRun() {
+    ProfileRun *profileRun = new ProfileRun;
+    profileRun->m_beginTick = profileTick();
+    profileRun->m_beginTime = std::chrono::steady_clock::now();
+    return profileRun;
+}
+
+void deleteProfileRun(ProfileRun *profileRun) {
+    if (profileRun == NULL) return;
+    for (int threadIndex = 0; threadIndex < profileRun->m_thread.size(); ++threadIndex) {
+        delete profileRun->m_thread[threadIndex];
+    }
+    delete profileRun;
+}
+
+ProfileThread *registerProfileThread() {
+    if (t_profileRun == NULL) return NULL;
+    ProfileThread *profileThread = new ProfileThread;
+    for (int scopeIndex = 0; scopeIndex < NUMPROFILESCOPE; ++scopeIndex) {
+        profileThread->m_counter[scopeIndex].m_count.store(0);
+        profileThread->m_counter[scopeIndex].m_tick.store(0);
+        profileThread->m_counter[scopeIndex].m_maxTick.store(0);
+    }
+
+    std::lock_guard<std::mutex> lock(t_profileRun->m_mutex);
+    t_profileRun->m_thread.push_back(profileThread);
+    t_profileThread = profileThread;
+    return profileThread;
+}
+
+bool writeProfile(ProfileRun *profileRun, const std::string &prefix) {
+    if (profileRun == NULL) return true;
+    std::lock_guard<std::mutex> lock(profileRun->m_mutex);
+
+    double nsPerTick = 1;
+#if defined(__x86_64__) || defined(__i386__)
+    double elapsedNs = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - profileRun->m_beginTime).count();
+    uint64_t elapsedTick = profileTick() - profileRun->m_beginTick;
+    if (elapsedTick > 0) nsPerTick = elapsedNs / elapsedTick;
+#endif
+
+    // rows of every thread, then the total of the process
+    int numThread = static_cast<int>(profileRun->m_thread.size());
+    std::vector<uint64_t> count((numThread + 1) * NUMPROFILESCOPE, 0),
+            tick((numThread + 1) * NUMPROFILESCOPE, 0),
+            maxTick((numThread + 1) * NUMPROFILESCOPE, 0);
+    for (int threadIndex = 0; threadIndex < numThread; ++threadIndex) {
+        for (int scopeIndex = 0; scopeIndex < NUMPROFILESCOPE; ++scopeIndex) {
+            const ProfileCounter &counter = profileRun->m_thread[threadIndex]->m_counter[scopeIndex];
+            int row = threadIndex * NUMPROFILESCOPE + scopeIndex,
+                    totalRow = numThread * NUMPROFILESCOPE + scopeIndex;
+            count[row] = counter.m_count.load(std::memory_order_relaxed);
+            tick[row] = counter.m_tick.load(std::memory_order_relaxed);
+            maxTick[row] = counter.m_maxTick.load(std::memory_order_relaxed);
+            count[totalRow] += count[row];
+            tick[totalRow] += tick[row];
+            maxTick[totalRow] = std::max(maxTick[totalRow], maxTick[row]);
+        }
+    }
+
+    std::ofstream jsonStream, csvStream;
+    std::string jsonFilename = prefix + ".json", csvFilename = prefix + ".csv";
+    jsonStream.open(jsonFilename.c_str(), std::ios_base::out);
+    csvStream.open(csvFilename.c_str(), std::ios_base::out);
+    if (jsonStream.is_open() == false || csvStream.is_open() == false) {
+        std::cerr << "Fail open profile file " << prefix << std::endl;
+        return false;
+    }
+
+    jsonStream << "{\n  \"nsPerTick\": " << nsPerTick << ",\n  \"threads\": [";
+    csvStream << "thread,scope,count,totalNs,avgNs,maxNs\n";
+    for (int threadIndex = 0; threadIndex <= numThread; ++threadIndex) {
+        bool isTotal = threadIndex == numThread;
+        if (isTotal) jsonStream << "\n  ],\n  \"total\": {";
+        else jsonStream << (threadIndex > 0 ? "," : "") << "\n    {\"thread\": " << threadIndex << ", \"scopes\": {";
+
+        bool isFirst = true;
+        for (int scopeIndex = 0; scopeIndex < NUMPROFILESCOPE; ++scopeIndex) {
+            int row = threadIndex * NUMPROFILESCOPE + scopeIndex;
+            if (count[row] == 0) continue;
+
+            double totalNs = tick[row] * nsPerTick, maxNs = maxTick[row] * nsPerTick;
+            jsonStream << (isFirst ? "" : ",") << (isTotal ? "\n    " : "\n      ")
+                       << "\"" << PROFILE_SCOPE_NAME[scopeIndex] << "\": {\"count\": " << count[row]
+                       << ", \"totalNs\": " << totalNs << ", \"maxNs\": " << maxNs << "}";
+            csvStream << (isTotal ? std::string("all") : std::to_string(threadIndex)) << ","
+                      << PROFILE_SCOPE_NAME[scopeIndex] << "," << count[row] << ","
+                      << totalNs << "," << totalNs / count[row] << "," << maxNs << "\n";
+            isFirst = false;
+        }
+        if (isTotal) jsonStream << "\n  }\n}\n";
+        else jsonStream << "\n    }}";
+    }
+
+    jsonStream.close();
+    csvStream.close();
+    return true;
+}
+
+#endif // FTL_PROFILE
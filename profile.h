@@ -0,0 +1,193 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Scoped wall-time counters of the hot paths, built only with FTL_PROFILE
+// defined (cmake -DFTL_PROFILE=ON); otherwise the scopes are empty and
+// writeProfile writes nothing. checkTime runs a few times per page, it is
+// only counted, the tasks it fires have their own timers.
+//
+// The counters belong to a ProfileRun, one per simulation: a thread counts
+// into the run it entered with a ProfileRunScope and not at all outside
+// one, so runs sharing a process (sweep) keep their profiles apart.
+
+enum ProfileScopeId {
+    PROFILE_READPAGE,
+    PROFILE_WRITEPAGE,
+    PROFILE_FINDFREEPAGE,
+    PROFILE_FINDFREE,
+    PROFILE_GC,
+    PROFILE_CHECKTIME,
+    PROFILE_DISSIPATE,
+    PROFILE_INJECTERR,
+    PROFILE_STATISTICERR,
+    PROFILE_STATISTICTEMPER,
+    NUMPROFILESCOPE
+};
+
+struct ProfileRun;
+
+#ifdef FTL_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ============== ProfileThread ====================
+
+/**
+ * @brief counters of one thread, only that thread writes them; relaxed
+ *        atomics let writeProfile read them while the thread still runs
+ */
+struct ProfileCounter {
+    std::atomic<uint64_t> m_count,
+        m_tick,
+        m_maxTick;
+};
+
+struct ProfileThread {
+    ProfileCounter m_counter[NUMPROFILESCOPE];
+};
+
+/**
+ * @brief registerProfileThread : counters of the calling thread in the run
+ *        it entered, kept with the run so short-lived workers are reported
+ *        too; NULL outside a run
+ */
+ProfileThread *registerProfileThread();
+extern thread_local ProfileRun *t_profileRun;
+extern thread_local ProfileThread *t_profileThread;
+
+/**
+ * @brief profileTick : TSC on x86, steady clock ns elsewhere
+ */
+inline uint64_t profileTick() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// ============== ProfileScope ====================
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileScopeId scopeId) : m_scopeId(scopeId), m_beginTick(profileTick()) {
+    }
+
+    ~ProfileScope() {
+        uint64_t tick = profileTick() - m_beginTick;
+        ProfileThread *profileThread = t_profileThread != NULL ? t_profileThread : registerProfileThread();
+        if (profileThread == NULL) return;
+        ProfileCounter &counter = profileThread->m_counter[m_scopeId];
+        counter.m_count.store(counter.m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counter.m_tick.store(counter.m_tick.load(std::memory_order_relaxed) + tick, std::memory_order_relaxed);
+        if (tick > counter.m_maxTick.load(std::memory_order_relaxed)) {
+            counter.m_maxTick.store(tick, std::memory_order_relaxed);
+        }
+    }
+private:
+    ProfileScope(const ProfileScope &);
+    ProfileScope &operator=(const ProfileScope &);
+
+    ProfileScopeId m_scopeId;
+    uint64_t m_beginTick;
+};
+
+#define FTL_PROFILE_SCOPE(scopeId) ProfileScope profileScope(scopeId)
+
+/**
+ * @brief countProfile : count only, for the paths too short to be timed
+ */
+inline void countProfile(ProfileScopeId scopeId) {
+    ProfileThread *profileThread = t_profileThread != NULL ? t_profileThread : registerProfileThread();
+    if (profileThread == NULL) return;
+    ProfileCounter &counter = profileThread->m_counter[scopeId];
+    counter.m_count.store(counter.m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+#define FTL_PROFILE_COUNT(scopeId) countProfile(scopeId)
+
+// ============== ProfileRun ====================
+
+ProfileRun *createProfileRun();
+void deleteProfileRun(ProfileRun *profileRun);
+
+/**
+ * @brief currentProfileRun : the run of the calling thread, handed to the
+ *        workers it starts
+ */
+inline ProfileRun *currentProfileRun() {
+    return t_profileRun;
+}
+
+/**
+ * @brief ProfileRunScope : the calling thread counts into profileRun until
+ *        the scope ends; NULL | the current run leave the current one
+ */
+class ProfileRunScope {
+public:
+    explicit ProfileRunScope(ProfileRun *profileRun)
+        : m_isEntered(profileRun != NULL && profileRun != t_profileRun),
+          m_outerRun(t_profileRun), m_outerThread(t_profileThread) {
+        if (m_isEntered == false) return;
+        t_profileRun = profileRun;
+        t_profileThread = NULL;
+    }
+
+    ~ProfileRunScope() {
+        if (m_isEntered == false) return;
+        t_profileRun = m_outerRun;
+        t_profileThread = m_outerThread;
+    }
+private:
+    ProfileRunScope(const ProfileRunScope &);
+    ProfileRunScope &operator=(const ProfileRunScope &);
+
+    bool m_isEntered;
+    ProfileRun *m_outerRun;
+    ProfileThread *m_outerThread;
+};
+
+/**
+ * @brief writeProfile : the counters of every thread of the run so far,
+ *        inclusive time, as prefix.json & prefix.csv
+ */
+bool writeProfile(ProfileRun *profileRun, const std::string &prefix);
+
+#else
+
+class ProfileRunScope {
+public:
+    explicit ProfileRunScope(ProfileRun *) {
+    }
+};
+
+inline ProfileRun *createProfileRun() {
+    return NULL;
+}
+
+inline void deleteProfileRun(ProfileRun *) {
+}
+
+inline ProfileRun *currentProfileRun() {
+    return NULL;
+}
+
+#define FTL_PROFILE_SCOPE(scopeId) ((void)0)
+#define FTL_PROFILE_COUNT(scopeId) ((void)0)
+
+inline bool writeProfile(ProfileRun *, const std::string &) {
+    return true;
+}
+
+#endif // FTL_PROFILE
+
+#endif // PROFILE_H
@@ -0,0 +1,88 @@
+#include "ftl.h"
+
+// IOPS & latency against the queue depth for every FTL method.
+// The traces of the config file run once per method, then the host
+// queues replay them at every queue depth (see HostQueue).
+//
+// usage: queuedepth configFile numQueue numUnit queueDepth...
+//
+// queueDepthCal: method queueDepth iops avgLatency p50 p99 max
+//                avgReadLatency avgWriteLatency unitBusy
+
+int main(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "usage: " << argv[0]
+                  << " configFile numQueue numUnit queueDepth..." << std::endl;
+        return 1;
+    }
+
+    std::string configFile(argv[1]);
+    int numQueue = atoi(argv[2]),
+            numUnit = atoi(argv[3]);
+    std::vector<int> queueDepthList;
+    for (int argIndex = 4; argIndex < argc; ++argIndex) {
+        int queueDepth = atoi(argv[argIndex]);
+        if (queueDepth < 1) {
+            std::cerr << "Wrong queue depth " << argv[argIndex] << std::endl;
+            return 1;
+        }
+        queueDepthList.push_back(queueDepth);
+    }
+
+    std::ofstream outStream;
+    outStream.open("queueDepthCal", std::ios_base::out);
+    if (outStream.is_open() == false) {
+        std::cerr << "Fail open output file" << std::endl;
+        return 2;
+    }
+
+    const char *methodList[] = {"1", "2", "3", "4"};
+    const int numMethod = sizeof(methodList) / sizeof(methodList[0]);
+    for (int methodIndex = 0; methodIndex < numMethod; ++methodIndex) {
+        Executor executor;
+        if (executor.readConfigFile(configFile) == false) return 1;
+        // numUnit 0 : one unit per level
+        HostQueue hostQueue(numQueue, numUnit > 0 ? numUnit : executor.m_levelPerChip);
+
+        SSD *ssd = createSSD(methodList[methodIndex]);
+        executor.m_verbose = false;
+        executor.m_temperShotPrefix.clear();
+        executor.m_errorFilename.clear();
+        executor.setSSD(ssd);
+        ssd->allocateSpace(&executor);
+        executor.initData();
+
+        TraceReader traceReader;
+        for (int traceIndex = 0; traceIndex < executor.m_traceFileNameList.size(); ++traceIndex) {
+            if (traceReader.open(executor.m_traceFileNameList[traceIndex]) == false) {
+                std::cerr << "Fail to open tracefile" << executor.m_traceFileNameList[traceIndex] << std::endl;
+                continue;
+            }
+            if (hostQueue.record(&executor, traceReader) == false) return 1;
+            traceReader.close();
+        }
+        delete ssd;
+
+        for (int depthIndex = 0; depthIndex < queueDepthList.size(); ++depthIndex) {
+            QueueDepthResult result = hostQueue.replay(queueDepthList[depthIndex]);
+            outStream << methodList[methodIndex] << "\t"
+                      << result.m_queueDepth << "\t"
+                      << result.m_iops << "\t"
+                      << result.m_avgLatency << "\t"
+                      << result.m_p50Latency << "\t"
+                      << result.m_p99Latency << "\t"
+                      << result.m_maxLatency << "\t"
+                      << result.m_avgReadLatency << "\t"
+                      << result.m_avgWriteLatency << "\t"
+                      << result.m_unitBusy << "\n";
+            std::cout << "method " << methodList[methodIndex]
+                      << " QD" << result.m_queueDepth
+                      << " iops " << result.m_iops
+                      << " avgLatency " << result.m_avgLatency
+                      << " p99 " << result.m_p99Latency << std::endl;
+        }
+    }
+
+    outStream.close();
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include "simulator.h"
+
+// errors per interval of the default table, stage i starts at 25 + 2i degree
+const static int DEFAULT_ERR_STAGE = 48;
+const static int DEFAULT_ERR_COUNT[DEFAULT_ERR_STAGE] = {
+    0, 0, 4, 4, 9, 9, 10, 10, 18, 18, 28, 28,
+    30, 30, 40, 40, 48, 48, 55, 55, 68, 68, 74, 74,
+    92, 92, 95, 95, 110, 110, 125, 125, 136, 136, 148, 148,
+    160, 160, 183, 183, 200, 200, 216, 216, 231, 231, 250, 250
+};
+
+// ====================SimulatorConfig=========================
+
+SimulatorConfig::SimulatorConfig() : m_methodNum("1"),
+    m_bytePerPage(4096), m_pagePerBlock(64), m_blockPerLine(128),
+    m_linePerLevel(64), m_levelPerChip(16), m_minimumFreeBlock(50),
+    m_logicPercent(0.8), m_isRealData(false),
+    m_readOobTime(0.0001), m_writeOobTime(0.0002),
+    m_readPageTime(0.04), m_writePageTime(0.1), m_eraseBlockTime(1),
+    m_lrTemperPercent(0.08), m_fbTemperPercent(0.04), m_udTemperPercent(0.02),
+    m_readPageTemper(0.08), m_writePageTemper(0.23), m_eraseBlockTemper(3.0),
+    m_scanTemperInterval(17000), m_dissTemperInterval(1920),
+    m_createErrInterval(1900), m_calErrInterval(4000),
+    m_eccNumBit(30), m_randomSeed(0), m_numThread(1), m_lazyErr(false) {
+
+    for (int stage = 0; stage < DEFAULT_ERR_STAGE; ++stage) {
+        m_temper2numBlockErr[25 + 2 * stage] = DEFAULT_ERR_COUNT[stage];
+    }
+}
+
+// ====================Simulator=========================
+
+Simulator::Simulator(Executor *executor, SSD *ssd) : m_executor(executor), m_ssd(ssd),
+    m_pageData(NULL), m_logicPage(0) {
+    m_pageData = new PageData(&m_ssd->m_dataContext);
+    m_dataModel.assign(m_executor->m_bytePerPage, 0);
+    m_logicPage = static_cast<long long>(m_executor->m_logicBlock) * m_executor->m_pagePerBlock;
+}
+
+Simulator::~Simulator() {
+    delete m_pageData;
+    delete m_ssd;
+    delete m_executor;
+}
+
+Simulator *Simulator::build(Executor *executor, const std::string &methodNum) {
+    SSD *ssd = createSSD(methodNum);
+    if (ssd == NULL) {
+        std::cerr << "Wrong method number !!!" << std::endl;
+        delete executor;
+        return NULL;
+    }
+    executor->m_verbose = false;
+    executor->setSSD(ssd);
+    ssd->allocateSpace(executor);
+    executor->initData();
+    return new Simulator(executor, ssd);
+}
+
+Simulator *Simulator::create(const SimulatorConfig &config) {
+    if (config.m_bytePerPage < 1 || config.m_pagePerBlock < 1 || config.m_blockPerLine < 1
+            || config.m_linePerLevel < 1 || config.m_levelPerChip < 1 || config.m_minimumFreeBlock < 1
+            || config.m_logicPercent <= 0 || config.m_logicPercent >= 1
+            || config.m_scanTemperInterval < 1 || config.m_dissTemperInterval < 1
+            || config.m_createErrInterval < 1 || config.m_calErrInterval < 1
+            || config.m_temper2numBlockErr.empty()) {
+        std::cerr << "Wrong simulator configuration !!!" << std::endl;
+        return NULL;
+    }
+
+    Executor *executor = new Executor;
+
+    executor->m_bytePerPage = config.m_bytePerPage;
+    executor->m_pagePerBlock = config.m_pagePerBlock;
+    executor->m_blockPerLine = config.m_blockPerLine;
+    executor->m_linePerLevel = config.m_linePerLevel;
+    executor->m_levelPerChip = config.m_levelPerChip;
+    executor->m_minimumFreeBlock = config.m_minimumFreeBlock;
+    executor->m_physicBlock = config.m_blockPerLine * config.m_linePerLevel * config.m_levelPerChip;
+    executor->m_logicBlock = static_cast<int>(executor->m_physicBlock * config.m_logicPercent);
+    executor->m_isRealData = config.m_isRealData;
+    executor->m_dataFromFile = false;
+
+    executor->m_readOobTime = config.m_readOobTime;
+    executor->m_writeOobTime = config.m_writeOobTime;
+    executor->m_readPageTime = config.m_readPageTime;
+    executor->m_writePageTime = config.m_writePageTime;
+    executor->m_eraseBlockTime = config.m_eraseBlockTime;
+
+    executor->m_lrTemperPercent = config.m_lrTemperPercent;
+    executor->m_fbTemperPercent = config.m_fbTemperPercent;
+    executor->m_udTemperPercent = config.m_udTemperPercent;
+
+    executor->m_readPageTemper = config.m_readPageTemper;
+    executor->m_writePageTemper = config.m_writePageTemper;
+    executor->m_eraseBlockTemper = config.m_eraseBlockTemper;
+
+    executor->m_scanTemperInterval = config.m_scanTemperInterval;
+    executor->m_dissTemperInterval = config.m_dissTemperInterval;
+    executor->m_createErrInterval = config.m_createErrInterval;
+    executor->m_calErrInterval = config.m_calErrInterval;
+
+    executor->m_temper2numBlockErr = config.m_temper2numBlockErr;
+    for (std::map<double, int>::const_iterator iterMap = config.m_temper2numBlockErr.begin();
+         iterMap != config.m_temper2numBlockErr.end(); ++iterMap) {
+        executor->m_errTemperStage.push_back(iterMap->first);
+        executor->m_errCountStage.push_back(iterMap->second);
+    }
+    executor->m_eccNumBit = config.m_eccNumBit;
+    executor->m_softEccNumBit = config.m_eccNumBit;
+    executor->m_decodeLevelCount.assign(2, 0);
+
+    executor->m_randomSeed = config.m_randomSeed;
+    if (executor->m_randomSeed == 0) executor->m_randomSeed = defaultSeed();
+    executor->m_numThread = config.m_numThread < 1 ? 1 : config.m_numThread;
+    executor->m_lazyErr = config.m_lazyErr;
+
+    // state files are only written by snapshot, under its prefix
+    executor->m_entryTableFile = "entryTable";
+    executor->m_replaceTableFile = "replaceTable";
+    executor->m_dataFilePrefix = "data";
+    executor->m_metaDataFile = "meta";
+    executor->m_freeBlockListFile = "freeBlockList";
+    executor->m_summaryFilename = "summaryFile";
+    executor->m_temperShotPrefix = config.m_temperShotPrefix;
+    executor->m_errorFilename = config.m_errorFilename;
+
+    return build(executor, config.m_methodNum);
+}
+
+Simulator *Simulator::createFromFile(std::string configFileName, std::string methodNum) {
+    Executor *executor = new Executor;
+    if (executor->readConfigFile(configFileName) == false) {
+        delete executor;
+        return NULL;
+    }
+    return build(executor, methodNum);
+}
+
+void Simulator::fitSettings() {
+    size_t numDecodeLevel = 2 + m_executor->m_retryEccNumBit.size();
+    if (m_executor->m_decodeLevelCount.size() < numDecodeLevel) {
+        m_executor->m_decodeLevelCount.resize(numDecodeLevel, 0);
+    }
+    if (m_executor->m_throttleScope == 1
+            && m_executor->m_levelMaxTemper.size() != static_cast<size_t>(m_executor->m_levelPerChip)) {
+        m_executor->m_levelMaxTemper.assign(m_executor->m_levelPerChip, 25);
+    }
+}
+
+bool Simulator::submit(SimOp op, int logicNum, int length) {
+    if (logicNum < 0 || length < 0 || logicNum + static_cast<long long>(length) > m_logicPage) {
+        return false;
+    }
+    fitSettings();
+
+    bool isWrite = op == SIM_WRITE;
+    for (int pageIndex = 0; pageIndex < length; ++pageIndex) {
+        if (m_executor->m_isRealData) m_pageData->setDataAsBit(&m_dataModel[0]);
+        else m_pageData->setDataAsErrCount(0);
+        m_executor->executeRequest(isWrite, logicNum + pageIndex, *m_pageData);
+    }
+    return true;
+}
+
+int Simulator::submit(const SimRequest *requestArr, int numRequest) {
+    int requestIndex = 0;
+    for (; requestIndex < numRequest; ++requestIndex) {
+        const SimRequest &request = requestArr[requestIndex];
+        if (submit(request.m_op, request.m_logicNum, request.m_length) == false) break;
+    }
+    return requestIndex;
+}
+
+SimulatorStats Simulator::getStats() {
+    SimulatorStats stats;
+
+    stats.m_maxEraseCount = 0;
+    stats.m_avgEraseCount = 0;
+    stats.m_maxTemper = 0;
+    for (int blockIndex = 0; blockIndex < m_ssd->m_physicBlock; ++blockIndex) {
+        BlockData *blockData = m_ssd->m_blockData[blockIndex];
+        stats.m_maxEraseCount = std::max(stats.m_maxEraseCount, blockData->getEraseCount());
+        stats.m_avgEraseCount += blockData->getEraseCount();
+        stats.m_maxTemper = std::max(stats.m_maxTemper, blockData->getTemper());
+    }
+    stats.m_avgEraseCount /= m_ssd->m_physicBlock;
+
+    stats.m_requestCount = m_executor->m_requestCount;
+    stats.m_readCount = m_executor->m_readCount;
+    stats.m_uncorrectableRead = m_executor->m_uncorrectableRead;
+    stats.m_injectErrCount = m_executor->m_injectErrCount;
+    stats.m_throttleEvent = m_executor->m_throttleEvent;
+    stats.m_migrateChain = m_executor->m_migrateChain;
+    stats.m_scrubRefreshChain = m_executor->m_scrubRefreshChain;
+
+    stats.m_simulateTime = m_executor->m_simulateTime;
+    stats.m_throttleTime = m_executor->m_throttleTime;
+    stats.m_peakTemper = m_executor->m_peakTemper;
+    stats.m_avgReadLatency = m_executor->m_readCount ?
+                m_executor->m_readLatencySum / m_executor->m_readCount : 0;
+    stats.m_maxReadLatency = m_executor->m_readLatencyMax;
+    return stats;
+}
+
+bool Simulator::snapshot(const std::string &prefix) {
+    return m_executor->snapshot(prefix);
+}
+
+Executor *Simulator::getExecutor() {
+    return m_executor;
+}
@@ -0,0 +1,148 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "ftl.h"
+
+// ============== SimulatorConfig ====================
+
+/**
+ * @brief configuration of an embedded simulator, the defaults are the
+ *        values of configFile.txt; the optional sections (throttling,
+ *        migration, read path, scrubbing ...) stay disabled, set them on
+ *        Simulator::getExecutor() before the first submit
+ */
+struct SimulatorConfig {
+    SimulatorConfig();
+
+    std::string m_methodNum; // "1" to "4", see createSSD
+
+    // stucture of SSD
+    int m_bytePerPage,
+        m_pagePerBlock,
+        m_blockPerLine,
+        m_linePerLevel,
+        m_levelPerChip,
+        m_minimumFreeBlock;
+    double m_logicPercent;
+    bool m_isRealData;
+
+    // time of the operations
+    double m_readOobTime,
+            m_writeOobTime,
+            m_readPageTime,
+            m_writePageTime,
+            m_eraseBlockTime;
+
+    // temperature dissipation percentage
+    double m_lrTemperPercent,
+            m_fbTemperPercent,
+            m_udTemperPercent;
+
+    // temperature raise
+    double m_readPageTemper,
+            m_writePageTemper,
+            m_eraseBlockTemper;
+
+    // time interval, as Executor keeps them
+    int m_scanTemperInterval,
+        m_dissTemperInterval,
+        m_createErrInterval,
+        m_calErrInterval;
+
+    // errors per interval from the temperature
+    std::map<double, int> m_temper2numBlockErr;
+    int m_eccNumBit;
+
+    uint64_t m_randomSeed; // 0 : defaultSeed()
+    int m_numThread;
+    bool m_lazyErr;
+
+    // statistic files, empty : not written
+    std::string m_temperShotPrefix;
+    std::string m_errorFilename;
+};
+
+// ============== SimulatorStats ====================
+
+struct SimulatorStats {
+    long long m_requestCount,
+            m_readCount,
+            m_uncorrectableRead,
+            m_injectErrCount,
+            m_throttleEvent,
+            m_migrateChain,
+            m_scrubRefreshChain;
+    double m_simulateTime,
+            m_throttleTime,
+            m_peakTemper,
+            m_maxTemper,
+            m_avgEraseCount,
+            m_avgReadLatency,
+            m_maxReadLatency;
+    int m_maxEraseCount;
+};
+
+enum SimOp {
+    SIM_READ,
+    SIM_WRITE
+};
+
+struct SimRequest {
+    SimOp m_op;
+    int m_logicNum; // first logic page
+    int m_length; // pages
+};
+
+// ============== Simulator ====================
+
+/**
+ * @brief in-process driver of one SSD, requests are submitted directly
+ *        instead of being read from trace files
+ */
+class Simulator {
+public:
+    /**
+     * @return NULL if the configuration is wrong
+     */
+    static Simulator *create(const SimulatorConfig &config);
+    static Simulator *createFromFile(std::string configFileName, std::string methodNum);
+    ~Simulator();
+
+    /**
+     * @brief submit : run length pages from logicNum, one request each
+     * @return false if a page is out of the logic space, nothing is run
+     */
+    bool submit(SimOp op, int logicNum, int length = 1);
+    /**
+     * @return number of requests run, stops at the first invalid one
+     */
+    int submit(const SimRequest *requestArr, int numRequest);
+
+    SimulatorStats getStats();
+    /**
+     * @brief snapshot : write the state & summary files as prefix + basename,
+     *                   the simulation goes on
+     */
+    bool snapshot(const std::string &prefix);
+
+    Executor *getExecutor();
+private:
+    explicit Simulator(Executor *executor, SSD *ssd);
+    Simulator(const Simulator &);
+    Simulator &operator=(const Simulator &);
+
+    static Simulator *build(Executor *executor, const std::string &methodNum);
+    /**
+     * @brief fitSettings : size the counters of the optional models to the
+     *                      settings made on getExecutor()
+     */
+    void fitSettings();
+
+    Executor *m_executor;
+    SSD *m_ssd;
+    PageData *m_pageData;
+    std::vector<char> m_dataModel; // all zero payload of a write
+    long long m_logicPage; // pages of the logic space
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,157 @@
+#include "ftl.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Runs a matrix of (method x config x trace) simulations in one process.
+// Every job owns its Executor & SSD and writes its state and statistic
+// files as outputDir/m<method>_c<config>_t<trace>_<basename>.
+//
+// usage: sweep specFile
+//
+// specFile (positional, like the config file):
+//   numThread
+//   numMethod method...
+//   numConfig configFile...
+//   numTrace traceFile...
+//   outputDir
+//
+// outputDir/sweepSummary: job method config trace ok wallTime(s)
+
+struct SweepJob {
+    int methodIndex;
+    int configIndex;
+    int traceIndex;
+    std::string prefix;
+    bool isOk;
+    double wallTime;
+};
+
+static bool readList(std::ifstream &inStream, std::vector<std::string> &list) {
+    int numItem = 0;
+    if (!(inStream >> numItem) || numItem < 1) return false;
+    list.resize(numItem);
+    for (int index = 0; index < numItem; ++index) {
+        if (!(inStream >> list[index])) return false;
+    }
+    return true;
+}
+
+static bool runJob(const std::string &methodNum, const std::string &configFile,
+                   const std::string &traceFile, const std::string &prefix) {
+    SSD *ssdPtr = createSSD(methodNum);
+    if (ssdPtr == NULL) {
+        std::cerr << "Wrong method number " << methodNum << std::endl;
+        return false;
+    }
+
+    Executor *executor = new Executor;
+    bool isOk = executor->readConfigFile(configFile);
+    if (isOk) {
+        executor->m_verbose = false;
+        executor->setTraceFile(traceFile);
+        executor->setSSD(ssdPtr);
+        ssdPtr->allocateSpace(executor);
+        executor->initData();
+        executor->redirectOutput(prefix);
+        isOk = executor->beginProcess() && executor->endProcess();
+    }
+
+    delete ssdPtr;
+    delete executor;
+    return isOk;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " specFile" << std::endl;
+        return 1;
+    }
+
+    std::ifstream inStream;
+    inStream.open(argv[1], std::ios_base::in);
+    if (inStream.is_open() == false) {
+        std::cerr << "Fail open spec file " << argv[1] << std::endl;
+        return 1;
+    }
+
+    int numThread = 0;
+    std::vector<std::string> methodList, configList, traceList;
+    std::string outputDir;
+    inStream >> numThread;
+    if (readList(inStream, methodList) == false
+            || readList(inStream, configList) == false
+            || readList(inStream, traceList) == false
+            || !(inStream >> outputDir)) {
+        std::cerr << "Wrong spec file " << argv[1] << std::endl;
+        return 1;
+    }
+    inStream.close();
+
+    if (numThread < 1) numThread = static_cast<int>(std::thread::hardware_concurrency());
+    if (numThread < 1) numThread = 1;
+    if (outputDir[outputDir.size() - 1] != '/') outputDir += "/";
+
+    std::vector<SweepJob> jobList;
+    for (int methodIndex = 0; methodIndex < methodList.size(); ++methodIndex) {
+        for (int configIndex = 0; configIndex < configList.size(); ++configIndex) {
+            for (int traceIndex = 0; traceIndex < traceList.size(); ++traceIndex) {
+                SweepJob job;
+                job.methodIndex = methodIndex;
+                job.configIndex = configIndex;
+                job.traceIndex = traceIndex;
+
+                std::ostringstream prefixStream;
+                prefixStream << outputDir << "m" << methodList[methodIndex]
+                             << "_c" << configIndex << "_t" << traceIndex << "_";
+                job.prefix = prefixStream.str();
+                job.isOk = false;
+                job.wallTime = 0;
+                jobList.push_back(job);
+            }
+        }
+    }
+
+    std::atomic<int> nextJob(0);
+    std::vector<std::thread> workerArr;
+    for (int threadIndex = 0; threadIndex < numThread && threadIndex < jobList.size(); ++threadIndex) {
+        workerArr.push_back(std::thread([&]() {
+            for (int jobIndex = nextJob++; jobIndex < jobList.size(); jobIndex = nextJob++) {
+                SweepJob &job = jobList[jobIndex];
+                std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                job.isOk = runJob(methodList[job.methodIndex], configList[job.configIndex],
+                                  traceList[job.traceIndex], job.prefix);
+                job.wallTime = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - begin).count();
+            }
+        }));
+    }
+    for (size_t index = 0; index < workerArr.size(); ++index) {
+        workerArr[index].join();
+    }
+
+    std::ofstream outStream;
+    std::string summaryFilename = outputDir + "sweepSummary";
+    outStream.open(summaryFilename.c_str(), std::ios_base::out);
+    if (outStream.is_open() == false) {
+        std::cerr << "Fail open " << summaryFilename << std::endl;
+        return 2;
+    }
+
+    int numFail = 0;
+    for (size_t jobIndex = 0; jobIndex < jobList.size(); ++jobIndex) {
+        const SweepJob &job = jobList[jobIndex];
+        if (job.isOk == false) ++numFail;
+        outStream << jobIndex << "\t"
+                  << methodList[job.methodIndex] << "\t"
+                  << configList[job.configIndex] << "\t"
+                  << traceList[job.traceIndex] << "\t"
+                  << job.isOk << "\t"
+                  << job.wallTime << "\n";
+    }
+    outStream.close();
+
+    std::cout << jobList.size() - numFail << "/" << jobList.size() << " jobs over" << std::endl;
+    return numFail == 0 ? 0 : 3;
+}
@@ -0,0 +1,218 @@
+#include "telemetry.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdint.h>
+
+static const char TELEMETRY_MAGIC[8] = {'F', 'T', 'L', 'T', 'E', 'L', 'E', 'M'};
+static const uint32_t TELEMETRY_VERSION = 1;
+
+// ============== encoding ====================
+
+static void putFixed(std::string &buffer, uint64_t value, int numByte) {
+    for (int byteIndex = 0; byteIndex < numByte; ++byteIndex) {
+        buffer.push_back(static_cast<char>((value >> (8 * byteIndex)) & 0xff));
+    }
+}
+
+static void putVarint(std::string &buffer, long long value) {
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        buffer.push_back(static_cast<char>((zigzag & 0x7f) | 0x80));
+        zigzag >>= 7;
+    }
+    buffer.push_back(static_cast<char>(zigzag));
+}
+
+static bool getFixed(std::ifstream &inStream, uint64_t &value, int numByte) {
+    unsigned char byte[8];
+    if (!inStream.read(reinterpret_cast<char*>(byte), numByte)) return false;
+    value = 0;
+    for (int byteIndex = 0; byteIndex < numByte; ++byteIndex) {
+        value |= static_cast<uint64_t>(byte[byteIndex]) << (8 * byteIndex);
+    }
+    return true;
+}
+
+static bool getVarint(const std::string &buffer, size_t &offset, long long &value) {
+    uint64_t zigzag = 0;
+    for (int shift = 0; offset < buffer.size() && shift < 64; shift += 7) {
+        unsigned char byte = static_cast<unsigned char>(buffer[offset++]);
+        zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            value = static_cast<long long>(zigzag >> 1) ^ -static_cast<long long>(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============== TelemetryWriter ====================
+
+TelemetryWriter::TelemetryWriter() : m_numRow(0) {
+}
+
+TelemetryWriter::~TelemetryWriter() {
+    close();
+}
+
+int TelemetryWriter::addColumn(const std::string &name, bool isReal) {
+    m_name.push_back(name);
+    m_isReal.push_back(isReal);
+    m_intValue.push_back(std::vector<long long>());
+    m_realValue.push_back(std::vector<double>());
+    m_lastInt.push_back(0);
+    return static_cast<int>(m_name.size()) - 1;
+}
+
+bool TelemetryWriter::open(const std::string &filename) {
+    m_outStream.open(filename.c_str(), std::ios_base::out | std::ios_base::binary);
+    if (m_outStream.is_open() == false) {
+        std::cerr << "Fail open telemetry file " << filename << std::endl;
+        return false;
+    }
+
+    std::string header(TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+    putFixed(header, TELEMETRY_VERSION, 4);
+    putFixed(header, m_name.size(), 4);
+    for (int column = 0; column < m_name.size(); ++column) {
+        putFixed(header, m_isReal[column] ? 1 : 0, 1);
+        putFixed(header, m_name[column].size(), 2);
+        header += m_name[column];
+    }
+    m_outStream.write(header.data(), header.size());
+
+    for (int column = 0; column < m_name.size(); ++column) {
+        m_intValue[column].assign(m_isReal[column] ? 0 : TELEMETRY_CHUNK, 0);
+        m_realValue[column].assign(m_isReal[column] ? TELEMETRY_CHUNK : 0, 0);
+    }
+    m_numRow = 0;
+    return m_outStream.good();
+}
+
+void TelemetryWriter::setInt(int column, long long value) {
+    m_intValue[column][m_numRow] = value;
+}
+
+void TelemetryWriter::setReal(int column, double value) {
+    m_realValue[column][m_numRow] = value;
+}
+
+bool TelemetryWriter::endRow() {
+    if (m_outStream.is_open() == false) return false;
+    if (++m_numRow < TELEMETRY_CHUNK) return true;
+    return writeChunk();
+}
+
+bool TelemetryWriter::close() {
+    if (m_outStream.is_open() == false) return true;
+    bool isOk = writeChunk();
+    m_outStream.close();
+    return isOk;
+}
+
+bool TelemetryWriter::writeChunk() {
+    if (m_numRow == 0) return m_outStream.good();
+
+    std::string chunk, values;
+    putFixed(chunk, m_numRow, 4);
+    for (int column = 0; column < m_name.size(); ++column) {
+        values.clear();
+        for (int row = 0; row < m_numRow; ++row) {
+            if (m_isReal[column]) {
+                uint64_t bits;
+                std::memcpy(&bits, &m_realValue[column][row], sizeof(bits));
+                putFixed(values, bits, 8);
+            } else {
+                putVarint(values, m_intValue[column][row] - m_lastInt[column]);
+                m_lastInt[column] = m_intValue[column][row];
+            }
+        }
+        putFixed(chunk, values.size(), 4);
+        chunk += values;
+    }
+    m_outStream.write(chunk.data(), chunk.size());
+    m_outStream.flush();
+    m_numRow = 0;
+    return m_outStream.good();
+}
+
+// ============== readTelemetry ====================
+
+bool readTelemetry(const std::string &filename, std::vector<TelemetryColumn> &column) {
+    std::ifstream inStream;
+    inStream.open(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (inStream.is_open() == false) {
+        std::cerr << "Fail open telemetry file " << filename << std::endl;
+        return false;
+    }
+
+    char magic[sizeof(TELEMETRY_MAGIC)];
+    uint64_t version, numColumn;
+    if (!inStream.read(magic, sizeof(magic)) || std::memcmp(magic, TELEMETRY_MAGIC, sizeof(magic)) != 0
+            || getFixed(inStream, version, 4) == false || version != TELEMETRY_VERSION
+            || getFixed(inStream, numColumn, 4) == false) {
+        std::cerr << "Not a telemetry file " << filename << std::endl;
+        return false;
+    }
+
+    column.assign(numColumn, TelemetryColumn());
+    for (int columnIndex = 0; columnIndex < numColumn; ++columnIndex) {
+        uint64_t isReal, nameLength;
+        if (getFixed(inStream, isReal, 1) == false || getFixed(inStream, nameLength, 2) == false) {
+            std::cerr << "Broken telemetry header " << filename << std::endl;
+            return false;
+        }
+        column[columnIndex].m_isReal = isReal != 0;
+        column[columnIndex].m_name.resize(nameLength);
+        if (nameLength > 0 && !inStream.read(&column[columnIndex].m_name[0], nameLength)) {
+            std::cerr << "Broken telemetry header " << filename << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<long long> lastInt(numColumn, 0);
+    std::string values;
+    uint64_t numRow, byteLength;
+    size_t totalRow = 0;
+    while (getFixed(inStream, numRow, 4)) {
+        totalRow += numRow;
+        for (int columnIndex = 0; columnIndex < numColumn; ++columnIndex) {
+            TelemetryColumn &current = column[columnIndex];
+            if (getFixed(inStream, byteLength, 4) == false) {
+                std::cerr << "Truncated telemetry chunk " << filename << std::endl;
+                return false;
+            }
+            values.resize(byteLength);
+            if (byteLength > 0 && !inStream.read(&values[0], byteLength)) {
+                std::cerr << "Truncated telemetry chunk " << filename << std::endl;
+                return false;
+            }
+
+            size_t offset = 0;
+            for (uint64_t row = 0; row < numRow; ++row) {
+                if (current.m_isReal) {
+                    if (offset + 8 > values.size()) break;
+                    uint64_t bits = 0;
+                    for (int byteIndex = 0; byteIndex < 8; ++byteIndex) {
+                        bits |= static_cast<uint64_t>(static_cast<unsigned char>(values[offset++])) << (8 * byteIndex);
+                    }
+                    double value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    current.m_realValue.push_back(value);
+                } else {
+                    long long delta;
+                    if (getVarint(values, offset, delta) == false) break;
+                    lastInt[columnIndex] += delta;
+                    current.m_intValue.push_back(lastInt[columnIndex]);
+                }
+            }
+            size_t numValue = current.m_isReal ? current.m_realValue.size() : current.m_intValue.size();
+            if (numValue != totalRow || offset != values.size()) {
+                std::cerr << "Broken telemetry chunk " << filename << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
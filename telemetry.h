@@ -0,0 +1,72 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Columnar time series of the drive state, one row per sample on the
+// simulated clock. File layout, little endian:
+//
+//   "FTLTELEM"  uint32 version  uint32 numColumn
+//   per column : uint8 isReal  uint16 nameLength  name
+//   chunks till the end of file :
+//     uint32 numRow
+//     per column : uint32 byteLength  values
+//
+// An integer column holds zigzag varints of the difference to the row
+// before (the counters grow slowly, most take a byte), a real column holds
+// raw float64. A chunk is written every TELEMETRY_CHUNK rows and at close.
+
+static const int TELEMETRY_CHUNK = 1024;
+
+// ============== TelemetryWriter ====================
+
+class TelemetryWriter {
+public:
+    explicit TelemetryWriter();
+    ~TelemetryWriter();
+
+    /**
+     * @brief addColumn : before open
+     * @return column index
+     */
+    int addColumn(const std::string &name, bool isReal);
+    bool open(const std::string &filename);
+    /**
+     * @brief setInt & setReal : value of the current row
+     */
+    void setInt(int column, long long value);
+    void setReal(int column, double value);
+    bool endRow();
+    bool close();
+private:
+    TelemetryWriter(const TelemetryWriter &);
+    TelemetryWriter &operator=(const TelemetryWriter &);
+
+    bool writeChunk();
+
+    std::ofstream m_outStream;
+    std::vector<std::string> m_name;
+    std::vector<bool> m_isReal;
+    std::vector<std::vector<long long> > m_intValue;
+    std::vector<std::vector<double> > m_realValue;
+    std::vector<long long> m_lastInt; // last row of the chunk before
+    int m_numRow;
+};
+
+// ============== readTelemetry ====================
+
+struct TelemetryColumn {
+    std::string m_name;
+    bool m_isReal;
+    std::vector<long long> m_intValue; // integer column
+    std::vector<double> m_realValue; // real column
+};
+
+/**
+ * @brief readTelemetry : every column of a telemetry file
+ */
+bool readTelemetry(const std::string &filename, std::vector<TelemetryColumn> &column);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,51 @@
+#include "telemetry.h"
+
+#include <iostream>
+#include <limits>
+
+// CSV export of a telemetry file written by Executor::sampleTelemetry
+// (summaryFile_telemetry), one row per sample, header from the columns.
+//
+// usage: telemetrycsv telemetryFile [csvFile]
+//
+// the CSV goes to stdout without csvFile
+
+int main(int argc, char *argv[]) {
+    if (argc != 2 && argc != 3) {
+        std::cerr << "usage: " << argv[0] << " telemetryFile [csvFile]" << std::endl;
+        return 1;
+    }
+
+    std::vector<TelemetryColumn> column;
+    if (readTelemetry(argv[1], column) == false) return 1;
+
+    std::ofstream fileStream;
+    if (argc == 3) {
+        fileStream.open(argv[2], std::ios_base::out);
+        if (fileStream.is_open() == false) {
+            std::cerr << "Fail open csv file " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &outStream = argc == 3 ? fileStream : std::cout;
+    outStream.precision(std::numeric_limits<double>::digits10);
+
+    size_t numRow = 0;
+    for (int columnIndex = 0; columnIndex < column.size(); ++columnIndex) {
+        outStream << (columnIndex > 0 ? "," : "") << column[columnIndex].m_name;
+        numRow = column[columnIndex].m_isReal ? column[columnIndex].m_realValue.size()
+                                              : column[columnIndex].m_intValue.size();
+    }
+    outStream << "\n";
+
+    for (size_t row = 0; row < numRow; ++row) {
+        for (int columnIndex = 0; columnIndex < column.size(); ++columnIndex) {
+            if (columnIndex > 0) outStream << ",";
+            if (column[columnIndex].m_isReal) outStream << column[columnIndex].m_realValue[row];
+            else outStream << column[columnIndex].m_intValue[row];
+        }
+        outStream << "\n";
+    }
+    outStream.flush();
+    return outStream.good() ? 0 : 1;
+}
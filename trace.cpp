@@ -0,0 +1,234 @@
+#include "trace.h"
+
+#include <cstring>
+#include <iostream>
+
+static const char TRACE_MAGIC[8] = {'F', 'T', 'L', 'T', 'R', 'A', 'C', 'E'};
+static const uint32_t TRACE_VERSION = 1;
+static const size_t TRACE_BUFFER_RECORD = 65536;
+
+static void putUint(char *buffer, uint64_t value, int numByte) {
+    for (int byteIndex = 0; byteIndex < numByte; ++byteIndex) {
+        buffer[byteIndex] = static_cast<char>((value >> (8 * byteIndex)) & 0xff);
+    }
+}
+
+static uint64_t getUint(const char *buffer, int numByte) {
+    uint64_t value = 0;
+    for (int byteIndex = 0; byteIndex < numByte; ++byteIndex) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(buffer[byteIndex])) << (8 * byteIndex);
+    }
+    return value;
+}
+
+bool readTraceGeometry(const std::string &configFile, int &bytePerPage, int &numLogicPage) {
+    std::ifstream inStream;
+    inStream.open(configFile.c_str(), std::ios_base::in);
+    if (inStream.is_open() == false) {
+        std::cerr << "Fail open config file " << configFile << std::endl;
+        return false;
+    }
+
+    int pagePerBlock, blockPerLine, linePerLevel, levelPerChip, minimumFreeBlock;
+    double logicBlockPercent;
+    if (!(inStream >> bytePerPage >> pagePerBlock >> blockPerLine >> linePerLevel
+          >> levelPerChip >> minimumFreeBlock >> logicBlockPercent)) {
+        std::cerr << "Wrong config file " << configFile << std::endl;
+        return false;
+    }
+    numLogicPage = static_cast<int>(blockPerLine * linePerLevel * levelPerChip * logicBlockPercent) * pagePerBlock;
+    return true;
+}
+
+void encodeTraceRecord(const TraceRecord &record, char *buffer) {
+    uint32_t word = static_cast<uint32_t>(record.m_logicNum) & 0x7fffffff;
+    if (record.m_isWrite) word |= 0x80000000u;
+    uint32_t interArrival;
+    std::memcpy(&interArrival, &record.m_interArrival, sizeof(interArrival));
+    putUint(buffer, word, 4);
+    putUint(buffer + 4, interArrival, 4);
+}
+
+// ============== TraceReader ====================
+
+TraceReader::TraceReader() : m_isBinary(false), m_isFail(false), m_lineIndex(0),
+    m_remainRecord(0), m_bufferBegin(0), m_bufferEnd(0) {
+}
+
+TraceReader::~TraceReader() {
+    close();
+}
+
+bool TraceReader::open(const std::string &filename) {
+    close();
+    m_isFail = false;
+    m_lineIndex = 0;
+    m_bufferBegin = m_bufferEnd = 0;
+
+    m_inStream.clear();
+    m_inStream.open(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (m_inStream.is_open() == false) return false;
+
+    char header[TRACE_HEADER_SIZE];
+    m_inStream.read(header, TRACE_HEADER_SIZE);
+    m_isBinary = m_inStream.gcount() == TRACE_HEADER_SIZE
+            && std::memcmp(header, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0;
+    if (m_isBinary == false) {
+        m_inStream.clear();
+        m_inStream.seekg(0);
+        return true;
+    }
+
+    if (getUint(header + 8, 4) != TRACE_VERSION || getUint(header + 12, 4) != TRACE_RECORD_SIZE) {
+        std::cerr << "Unknown trace version " << filename << std::endl;
+        m_inStream.close();
+        return false;
+    }
+    m_remainRecord = getUint(header + 16, 8);
+    if (m_remainRecord == 0) m_remainRecord = UINT64_MAX;
+    m_buffer.resize(TRACE_BUFFER_RECORD * TRACE_RECORD_SIZE);
+    return true;
+}
+
+void TraceReader::close() {
+    if (m_inStream.is_open()) m_inStream.close();
+}
+
+bool TraceReader::isOpen() {
+    return m_inStream.is_open();
+}
+
+bool TraceReader::isBinary() {
+    return m_isBinary;
+}
+
+bool TraceReader::fail() {
+    return m_isFail;
+}
+
+bool TraceReader::refill() {
+    if (m_remainRecord == 0) return false;
+
+    uint64_t numRecord = m_remainRecord < TRACE_BUFFER_RECORD ? m_remainRecord : TRACE_BUFFER_RECORD;
+    m_inStream.read(&m_buffer[0], numRecord * TRACE_RECORD_SIZE);
+    size_t readSize = static_cast<size_t>(m_inStream.gcount());
+    if (readSize % TRACE_RECORD_SIZE != 0
+            || (readSize < numRecord * TRACE_RECORD_SIZE && m_remainRecord != UINT64_MAX)) {
+        std::cerr << "Truncated binary trace at record " << m_lineIndex << std::endl;
+        m_isFail = true;
+        return false;
+    }
+    if (m_remainRecord != UINT64_MAX) m_remainRecord -= numRecord;
+    else if (readSize == 0) m_remainRecord = 0;
+    m_bufferBegin = 0;
+    m_bufferEnd = readSize;
+    return readSize > 0;
+}
+
+bool TraceReader::next(TraceRecord &record) {
+    if (m_inStream.is_open() == false || m_isFail) return false;
+
+    if (m_isBinary) {
+        if (m_bufferBegin == m_bufferEnd && refill() == false) return false;
+        const char *buffer = &m_buffer[m_bufferBegin];
+        uint32_t word = static_cast<uint32_t>(getUint(buffer, 4)),
+                interArrival = static_cast<uint32_t>(getUint(buffer + 4, 4));
+        record.m_logicNum = static_cast<int>(word & 0x7fffffff);
+        record.m_isWrite = (word & 0x80000000u) != 0;
+        std::memcpy(&record.m_interArrival, &interArrival, sizeof(interArrival));
+        m_bufferBegin += TRACE_RECORD_SIZE;
+        ++m_lineIndex;
+        return true;
+    }
+
+    std::string cmd;
+    if (!(m_inStream >> record.m_logicNum)) {
+        // blanks up to the end of file close the trace
+        if (m_inStream.eof() == false) {
+            std::cerr << "Fail to process request line " << m_lineIndex << std::endl;
+            m_isFail = true;
+        }
+        return false;
+    }
+    if (!(m_inStream >> cmd) || (cmd != std::string("r") && cmd != std::string("w"))) {
+        std::cerr << "Fail to process request line " << m_lineIndex << std::endl;
+        m_isFail = true;
+        return false;
+    }
+    record.m_isWrite = cmd == std::string("w");
+    record.m_interArrival = 0;
+    ++m_lineIndex;
+    return true;
+}
+
+// ============== TraceWriter ====================
+
+TraceWriter::TraceWriter() : m_numRecord(0) {
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::open(const std::string &filename) {
+    close();
+    m_outStream.open(filename.c_str(), std::ios_base::out | std::ios_base::binary);
+    if (m_outStream.is_open() == false) {
+        std::cerr << "Fail open trace file " << filename << std::endl;
+        return false;
+    }
+
+    // the record count is written at close
+    char header[TRACE_HEADER_SIZE];
+    std::memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    putUint(header + 8, TRACE_VERSION, 4);
+    putUint(header + 12, TRACE_RECORD_SIZE, 4);
+    putUint(header + 16, 0, 8);
+    m_outStream.write(header, TRACE_HEADER_SIZE);
+
+    m_numRecord = 0;
+    m_buffer.clear();
+    m_buffer.reserve(TRACE_BUFFER_RECORD * TRACE_RECORD_SIZE);
+    return m_outStream.good();
+}
+
+bool TraceWriter::append(const TraceRecord &record) {
+    size_t offset = m_buffer.size();
+    m_buffer.resize(offset + TRACE_RECORD_SIZE);
+    encodeTraceRecord(record, &m_buffer[offset]);
+    ++m_numRecord;
+    if (m_buffer.size() < TRACE_BUFFER_RECORD * TRACE_RECORD_SIZE) return true;
+    return flush();
+}
+
+bool TraceWriter::appendEncoded(const char *buffer, size_t numRecord) {
+    if (flush() == false) return false;
+    m_outStream.write(buffer, numRecord * TRACE_RECORD_SIZE);
+    m_numRecord += numRecord;
+    return m_outStream.good();
+}
+
+bool TraceWriter::flush() {
+    if (m_buffer.empty() == false) {
+        m_outStream.write(&m_buffer[0], m_buffer.size());
+        m_buffer.clear();
+    }
+    return m_outStream.good();
+}
+
+bool TraceWriter::close() {
+    if (m_outStream.is_open() == false) return true;
+
+    bool isOk = flush();
+    char numRecord[8];
+    putUint(numRecord, m_numRecord, 8);
+    m_outStream.seekp(16);
+    m_outStream.write(numRecord, sizeof(numRecord));
+    isOk = m_outStream.good() && isOk;
+    m_outStream.close();
+    return isOk;
+}
+
+uint64_t TraceWriter::getNumRecord() {
+    return m_numRecord;
+}
@@ -0,0 +1,105 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Page requests of a trace file, in one of two formats:
+//
+// text   : "logicNum\tr|w" per line
+// binary : header "FTLTRACE"  uint32 version  uint32 recordSize
+//                 uint64 numRecord (0 : up to the end of the file)
+//          then records of TRACE_RECORD_SIZE bytes, little endian:
+//                 uint32 logicNum | isWrite << 31,  float32 interArrival
+//
+// A binary record has a fixed size, so a file splits into ranges that
+// are read or written in parallel.
+
+static const int TRACE_HEADER_SIZE = 24;
+static const int TRACE_RECORD_SIZE = 8;
+
+struct TraceRecord {
+    int m_logicNum;
+    bool m_isWrite;
+    float m_interArrival; // time since the request before, 0 in text traces
+};
+
+/**
+ * @brief readTraceGeometry : page size & logic page count of the SSD of a
+ *                            config file, the space a trace addresses
+ */
+bool readTraceGeometry(const std::string &configFile, int &bytePerPage, int &numLogicPage);
+
+/**
+ * @brief encodeTraceRecord : TRACE_RECORD_SIZE bytes of a binary record
+ */
+void encodeTraceRecord(const TraceRecord &record, char *buffer);
+
+// ============== TraceReader ====================
+
+class TraceReader {
+public:
+    explicit TraceReader();
+    ~TraceReader();
+
+    /**
+     * @brief open : the format is told by the header
+     */
+    bool open(const std::string &filename);
+    void close();
+    bool isOpen();
+    bool isBinary();
+    /**
+     * @return false at the end of the trace or on a broken request,
+     *         fail() tells the two apart
+     */
+    bool next(TraceRecord &record);
+    bool fail();
+private:
+    TraceReader(const TraceReader &);
+    TraceReader &operator=(const TraceReader &);
+
+    bool refill();
+
+    std::ifstream m_inStream;
+    bool m_isBinary,
+            m_isFail;
+    long long m_lineIndex;
+    uint64_t m_remainRecord; // binary records still in the file
+    std::vector<char> m_buffer;
+    size_t m_bufferBegin,
+            m_bufferEnd;
+};
+
+// ============== TraceWriter ====================
+
+class TraceWriter {
+public:
+    explicit TraceWriter();
+    ~TraceWriter();
+
+    bool open(const std::string &filename);
+    bool append(const TraceRecord &record);
+    /**
+     * @brief appendEncoded : numRecord records made by encodeTraceRecord
+     */
+    bool appendEncoded(const char *buffer, size_t numRecord);
+    /**
+     * @brief close : flush & write the record count into the header
+     */
+    bool close();
+    uint64_t getNumRecord();
+private:
+    TraceWriter(const TraceWriter &);
+    TraceWriter &operator=(const TraceWriter &);
+
+    bool flush();
+
+    std::ofstream m_outStream;
+    std::vector<char> m_buffer;
+    uint64_t m_numRecord;
+};
+
+#endif // TRACE_H
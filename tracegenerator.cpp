@@ -1,79 +1,384 @@
-#include <iostream>
-#include <fstream>
-#include <random>
-
-#include <cstdlib>
-
-int main(int ac, char **av) {
-
-    if (ac != 4) {
-        std::cerr << "Wrong num of argument \n";
-        return 1;
-    }
-
-    std::ifstream inStream;
-    inStream.open(av[1], std::ios_base::in);
-    if (inStream.is_open() == false) {
-        std::cerr << "Fail open configur File \n";
-        return 1;
-    }
-
-    std::ofstream outStream;
-    outStream.open(av[2], std::ios_base::out);
-    if (outStream.is_open() == false) {
-        std::cerr << "Fail open output file \n";
-        return 2;
-    }
-
-    int amountTrace = atoi(av[3]);
-    if (amountTrace < 1) {
-        std::cerr << "Fail transfer amount trace \n";
-        return 3;
-    }
-
-
-    int bytePerPage,
-            pagePerBlock,
-            blockPerLine,
-            linePerLevel,
-            levelPerChip,
-            minimumFreeBlock,
-            numlogicPage;
-    double logicBlockPercent;
-    inStream >> bytePerPage
-            >> pagePerBlock
-            >> blockPerLine
-            >> linePerLevel
-            >> levelPerChip
-            >> minimumFreeBlock
-            >> logicBlockPercent;
-    numlogicPage = (static_cast<int>(blockPerLine * linePerLevel *
-                                  levelPerChip * logicBlockPercent)) * pagePerBlock;
-
-    inStream.close();
-
-    int logicPage = 0;
-    std::default_random_engine generator(time(NULL));
-    std::uniform_int_distribution<int> distribution(0, numlogicPage -1);
-    for (int index = 0; index < amountTrace; ++index) {
-        logicPage = distribution(generator);
-        for (int pageNum = 0; pageNum < 8 &&  logicPage < numlogicPage;
-             ++pageNum, ++logicPage) {
-            outStream << logicPage << "\tw\n";
-        }
-    }
-
-    std::default_random_engine generatorR(time(NULL));
-    std::uniform_int_distribution<int> distributionR(static_cast<int>(numlogicPage / 10.0 * 9), numlogicPage -1);
-    for (int index = 0 ; index < amountTrace; ++index) {
-        logicPage = distributionR(generatorR);
-        for (int pageNum = 0; pageNum < 8 &&  logicPage < numlogicPage;
-             ++pageNum, ++logicPage) {
-            outStream << logicPage << "\tr\n";
-        }
-    }
-
-
-    outStream.close();
-    return 0;
-}
+#include "ftl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Synthetic workload generator, writes a binary trace (see trace.h).
+//
+// usage: tracegenerator specFile outputFile [seed]
+// seed 0 | none : FTL_SEED of the build, the wall clock if that is 0 too
+//
+// specFile (positional, like the config file; a relative configFile is
+// taken from the directory of the spec file):
+//   configFile                         logic capacity of the SSD
+//   numRequest                         a request spans one page or more
+//   numThread                          0 : hardware threads
+//   arrivalModel meanInterArrival      fixed | exponential | pareto shape
+//   numSize size weight...             request size in pages
+//   numPattern, then per pattern:
+//     weight readRatio uniform
+//     weight readRatio zipf theta                 0 < theta < 1, hot pages scattered
+//     weight readRatio hotspot start fraction hotRatio
+//                                      [start, start + fraction) of the space
+//                                      takes hotRatio of the requests
+//     weight readRatio sequential runLength       runs of runLength requests
+//
+// The requests are drawn in chunks of GENERATE_CHUNK, chunk c from the
+// Philox stream (seed, c), so the trace does not depend on numThread;
+// sequential runs restart at a chunk boundary.
+
+static const long long GENERATE_CHUNK = 1 << 16;
+
+enum ArrivalModel {
+    ARRIVAL_FIXED,
+    ARRIVAL_EXPONENTIAL,
+    ARRIVAL_PARETO
+};
+
+enum PatternKind {
+    PATTERN_UNIFORM,
+    PATTERN_ZIPF,
+    PATTERN_HOTSPOT,
+    PATTERN_SEQUENTIAL
+};
+
+struct Pattern {
+    PatternKind kind;
+    double weight;
+    double readRatio;
+    // zipf
+    double theta, zetaN, alpha, eta;
+    uint64_t scramble; // rank -> page, coprime with the page count
+    // hotspot
+    int hotStart, hotPage;
+    double hotRatio;
+    // sequential
+    int runLength;
+};
+
+struct WorkloadSpec {
+    int numLogicPage;
+    long long numRequest;
+    int numThread;
+    ArrivalModel arrivalModel;
+    double meanInterArrival, paretoShape;
+    std::vector<int> sizeList;
+    std::vector<double> sizeCumWeight;
+    std::vector<Pattern> patternList;
+    std::vector<double> patternCumWeight;
+};
+
+/**
+ * @brief zetaOf : sum of 1 / i^theta for i in [1, n], in fixed slices
+ *                 summed in order, the same whatever numThread
+ */
+static double zetaOf(int n, double theta, int numThread) {
+    const int numSlice = 64;
+    std::vector<double> partSum(numSlice, 0);
+    std::atomic<int> nextSlice(0);
+    std::vector<std::thread> workerArr;
+    for (int threadIndex = 0; threadIndex < numThread; ++threadIndex) {
+        workerArr.push_back(std::thread([&]() {
+            for (int slice = nextSlice++; slice < numSlice; slice = nextSlice++) {
+                long long begin = static_cast<long long>(n) * slice / numSlice + 1,
+                        end = static_cast<long long>(n) * (slice + 1) / numSlice;
+                double sum = 0;
+                for (long long index = begin; index <= end; ++index) sum += std::pow(static_cast<double>(index), -theta);
+                partSum[slice] = sum;
+            }
+        }));
+    }
+    for (int index = 0; index < workerArr.size(); ++index) workerArr[index].join();
+
+    double zeta = 0;
+    for (int slice = 0; slice < numSlice; ++slice) zeta += partSum[slice];
+    return zeta;
+}
+
+static uint64_t gcdOf(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t rest = a % b;
+        a = b;
+        b = rest;
+    }
+    return a;
+}
+
+static bool readSpec(const std::string &specFile, WorkloadSpec &spec) {
+    std::ifstream inStream;
+    inStream.open(specFile.c_str(), std::ios_base::in);
+    if (inStream.is_open() == false) {
+        std::cerr << "Fail open spec file " << specFile << std::endl;
+        return false;
+    }
+
+    std::string configFile, arrivalName;
+    if (!(inStream >> configFile >> spec.numRequest >> spec.numThread >> arrivalName)) {
+        std::cerr << "Wrong spec file " << specFile << std::endl;
+        return false;
+    }
+    std::string::size_type slash = specFile.find_last_of('/');
+    if (configFile[0] != '/' && slash != std::string::npos) {
+        configFile = specFile.substr(0, slash + 1) + configFile;
+    }
+    int bytePerPage;
+    if (readTraceGeometry(configFile, bytePerPage, spec.numLogicPage) == false) return false;
+    if (spec.numLogicPage < 1 || spec.numRequest < 1) {
+        std::cerr << "Empty workload in " << specFile << std::endl;
+        return false;
+    }
+    if (spec.numThread < 1) spec.numThread = static_cast<int>(std::thread::hardware_concurrency());
+    if (spec.numThread < 1) spec.numThread = 1;
+
+    // inter-arrival time
+    spec.paretoShape = 0;
+    if (arrivalName == "fixed") spec.arrivalModel = ARRIVAL_FIXED;
+    else if (arrivalName == "exponential") spec.arrivalModel = ARRIVAL_EXPONENTIAL;
+    else if (arrivalName == "pareto") spec.arrivalModel = ARRIVAL_PARETO;
+    else {
+        std::cerr << "Unknown arrival model " << arrivalName << std::endl;
+        return false;
+    }
+    if (!(inStream >> spec.meanInterArrival) || spec.meanInterArrival < 0
+            || (spec.arrivalModel == ARRIVAL_PARETO && (!(inStream >> spec.paretoShape) || spec.paretoShape <= 1))) {
+        std::cerr << "Wrong arrival model in " << specFile << std::endl;
+        return false;
+    }
+
+    // request size
+    int numSize = 0;
+    double weightSum = 0;
+    if (!(inStream >> numSize) || numSize < 1) {
+        std::cerr << "Wrong request sizes in " << specFile << std::endl;
+        return false;
+    }
+    for (int sizeIndex = 0; sizeIndex < numSize; ++sizeIndex) {
+        int size;
+        double weight;
+        if (!(inStream >> size >> weight) || size < 1 || weight < 0) {
+            std::cerr << "Wrong request sizes in " << specFile << std::endl;
+            return false;
+        }
+        weightSum += weight;
+        spec.sizeList.push_back(size);
+        spec.sizeCumWeight.push_back(weightSum);
+    }
+
+    // access patterns
+    int numPattern = 0;
+    if (!(inStream >> numPattern) || numPattern < 1) {
+        std::cerr << "Wrong patterns in " << specFile << std::endl;
+        return false;
+    }
+    double patternWeightSum = 0;
+    for (int patternIndex = 0; patternIndex < numPattern; ++patternIndex) {
+        Pattern pattern;
+        std::string kindName;
+        if (!(inStream >> pattern.weight >> pattern.readRatio >> kindName) || pattern.weight < 0) {
+            std::cerr << "Wrong pattern " << patternIndex << " in " << specFile << std::endl;
+            return false;
+        }
+
+        bool isOk = true;
+        if (kindName == "uniform") {
+            pattern.kind = PATTERN_UNIFORM;
+        } else if (kindName == "zipf") {
+            pattern.kind = PATTERN_ZIPF;
+            isOk = (inStream >> pattern.theta) && pattern.theta > 0 && pattern.theta < 1;
+            if (isOk) {
+                int n = spec.numLogicPage;
+                double zeta2 = 1 + std::pow(2.0, -pattern.theta);
+                pattern.zetaN = zetaOf(n, pattern.theta, spec.numThread);
+                pattern.alpha = 1 / (1 - pattern.theta);
+                pattern.eta = (1 - std::pow(2.0 / n, 1 - pattern.theta)) / (1 - zeta2 / pattern.zetaN);
+                pattern.scramble = 0x9E3779B1ull % n;
+                while (pattern.scramble == 0 || gcdOf(pattern.scramble, n) != 1) ++pattern.scramble;
+            }
+        } else if (kindName == "hotspot") {
+            pattern.kind = PATTERN_HOTSPOT;
+            double start, fraction;
+            isOk = (inStream >> start >> fraction >> pattern.hotRatio)
+                    && start >= 0 && fraction > 0 && start + fraction <= 1;
+            pattern.hotStart = static_cast<int>(start * spec.numLogicPage);
+            pattern.hotPage = std::max(1, static_cast<int>(fraction * spec.numLogicPage));
+            pattern.hotPage = std::min(pattern.hotPage, spec.numLogicPage - pattern.hotStart);
+        } else if (kindName == "sequential") {
+            pattern.kind = PATTERN_SEQUENTIAL;
+            isOk = (inStream >> pattern.runLength) && pattern.runLength > 0;
+        } else {
+            isOk = false;
+        }
+        if (isOk == false) {
+            std::cerr << "Wrong pattern " << kindName << " in " << specFile << std::endl;
+            return false;
+        }
+        patternWeightSum += pattern.weight;
+        spec.patternList.push_back(pattern);
+        spec.patternCumWeight.push_back(patternWeightSum);
+    }
+    if (weightSum <= 0 || patternWeightSum <= 0) {
+        std::cerr << "Zero weights in " << specFile << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static int pickWeighted(const std::vector<double> &cumWeight, double draw) {
+    int index = std::upper_bound(cumWeight.begin(), cumWeight.end(), draw * cumWeight.back()) - cumWeight.begin();
+    return std::min(index, static_cast<int>(cumWeight.size()) - 1);
+}
+
+/**
+ * @brief generateChunk : the requests [first, first + numRequest) as
+ *                        encoded records
+ */
+static size_t generateChunk(const WorkloadSpec &spec, uint64_t seed, long long chunkIndex,
+                            long long numRequest, std::vector<char> &buffer) {
+    CounterRandom random(seed, static_cast<uint32_t>(chunkIndex), static_cast<uint32_t>(chunkIndex >> 32));
+    int numLogicPage = spec.numLogicPage;
+    std::vector<int> seqNext(spec.patternList.size(), 0), seqRemain(spec.patternList.size(), 0);
+
+    buffer.clear();
+    size_t numRecord = 0;
+    TraceRecord record;
+    for (long long requestIndex = 0; requestIndex < numRequest; ++requestIndex) {
+        int patternIndex = pickWeighted(spec.patternCumWeight, random.uniformReal());
+        const Pattern &pattern = spec.patternList[patternIndex];
+        int size = spec.sizeList[pickWeighted(spec.sizeCumWeight, random.uniformReal())];
+        bool isWrite = random.uniformReal() >= pattern.readRatio;
+
+        int startPage = 0;
+        switch (pattern.kind) {
+        case PATTERN_UNIFORM:
+            startPage = random.uniformInt(numLogicPage);
+            break;
+        case PATTERN_ZIPF: {
+            // Gray et al., quickly generating billion-record synthetic databases
+            double draw = random.uniformReal(), drawZeta = draw * pattern.zetaN;
+            long long rank = 0;
+            if (drawZeta < 1) rank = 0;
+            else if (drawZeta < 1 + std::pow(0.5, pattern.theta)) rank = 1;
+            else rank = static_cast<long long>(numLogicPage * std::pow(pattern.eta * draw - pattern.eta + 1, pattern.alpha));
+            rank = std::min(rank, static_cast<long long>(numLogicPage) - 1);
+            startPage = static_cast<int>(static_cast<uint64_t>(rank) * pattern.scramble % numLogicPage);
+            break;
+        }
+        case PATTERN_HOTSPOT:
+            if (random.uniformReal() < pattern.hotRatio) {
+                startPage = pattern.hotStart + random.uniformInt(pattern.hotPage);
+            } else {
+                startPage = random.uniformInt(numLogicPage);
+            }
+            break;
+        case PATTERN_SEQUENTIAL:
+            if (seqRemain[patternIndex] == 0 || seqNext[patternIndex] >= numLogicPage) {
+                seqNext[patternIndex] = random.uniformInt(numLogicPage);
+                seqRemain[patternIndex] = pattern.runLength;
+            }
+            startPage = seqNext[patternIndex];
+            seqNext[patternIndex] += size;
+            --seqRemain[patternIndex];
+            break;
+        }
+
+        double draw = random.uniformReal(), interArrival = spec.meanInterArrival;
+        if (spec.arrivalModel == ARRIVAL_EXPONENTIAL) {
+            interArrival = -spec.meanInterArrival * std::log(1 - draw);
+        } else if (spec.arrivalModel == ARRIVAL_PARETO) {
+            double scale = spec.meanInterArrival * (spec.paretoShape - 1) / spec.paretoShape;
+            interArrival = scale / std::pow(1 - draw, 1 / spec.paretoShape);
+        }
+
+        // page-granular records, the first one carries the arrival gap
+        record.m_isWrite = isWrite;
+        record.m_interArrival = static_cast<float>(interArrival);
+        for (int pageIndex = 0; pageIndex < size && startPage + pageIndex < numLogicPage; ++pageIndex) {
+            record.m_logicNum = startPage + pageIndex;
+            buffer.resize((numRecord + 1) * TRACE_RECORD_SIZE);
+            encodeTraceRecord(record, &buffer[numRecord * TRACE_RECORD_SIZE]);
+            ++numRecord;
+            record.m_interArrival = 0;
+        }
+    }
+    return numRecord;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cerr << "usage: " << argv[0] << " specFile outputFile [seed]" << std::endl;
+        return 1;
+    }
+
+    WorkloadSpec spec;
+    if (readSpec(argv[1], spec) == false) return 1;
+
+    uint64_t seed = argc == 4 ? strtoull(argv[3], NULL, 10) : 0;
+    if (seed == 0) seed = defaultSeed();
+
+    TraceWriter traceWriter;
+    if (traceWriter.open(argv[2]) == false) return 2;
+
+    // workers draw chunks in any order, the writer takes them in order;
+    // a worker waits while its chunk is window chunks ahead of the writer
+    long long numChunk = (spec.numRequest + GENERATE_CHUNK - 1) / GENERATE_CHUNK;
+    int window = 2 * spec.numThread;
+    std::vector<std::vector<char> > slotBuffer(window);
+    std::vector<size_t> slotRecord(window, 0);
+    std::vector<long long> slotChunk(window, -1);
+    long long numWritten = 0;
+    std::mutex mutex;
+    std::condition_variable slotCond;
+
+    std::atomic<long long> nextChunk(0);
+    std::vector<std::thread> workerArr;
+    for (int threadIndex = 0; threadIndex < spec.numThread; ++threadIndex) {
+        workerArr.push_back(std::thread([&]() {
+            std::vector<char> buffer;
+            for (long long chunkIndex = nextChunk++; chunkIndex < numChunk; chunkIndex = nextChunk++) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    slotCond.wait(lock, [&]() { return chunkIndex < numWritten + window; });
+                }
+                long long numRequest = std::min(GENERATE_CHUNK, spec.numRequest - chunkIndex * GENERATE_CHUNK);
+                size_t numRecord = generateChunk(spec, seed, chunkIndex, numRequest, buffer);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                int slot = static_cast<int>(chunkIndex % window);
+                slotBuffer[slot].swap(buffer);
+                slotRecord[slot] = numRecord;
+                slotChunk[slot] = chunkIndex;
+                slotCond.notify_all();
+            }
+        }));
+    }
+
+    bool isOk = true;
+    std::vector<char> buffer;
+    for (long long chunkIndex = 0; chunkIndex < numChunk; ++chunkIndex) {
+        int slot = static_cast<int>(chunkIndex % window);
+        size_t numRecord;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotCond.wait(lock, [&]() { return slotChunk[slot] == chunkIndex; });
+            buffer.swap(slotBuffer[slot]);
+            numRecord = slotRecord[slot];
+            slotChunk[slot] = -1;
+            numWritten = chunkIndex + 1;
+            slotCond.notify_all();
+        }
+        if (isOk && numRecord > 0) isOk = traceWriter.appendEncoded(&buffer[0], numRecord);
+    }
+    for (int index = 0; index < workerArr.size(); ++index) workerArr[index].join();
+
+    isOk = traceWriter.close() && isOk;
+    if (isOk == false) {
+        std::cerr << "Fail write trace " << argv[2] << std::endl;
+        return 2;
+    }
+    std::cout << spec.numRequest << " requests, " << traceWriter.getNumRecord() << " pages" << std::endl;
+    return 0;
+}
@@ -0,0 +1,327 @@
+#include "ftl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+// Converts a public block I/O trace into a binary trace (see trace.h) of
+// the SSD of a config file.
+//
+// usage: traceimport format configFile inputFile outputFile [numThread]
+// numThread 0 | none : hardware threads
+//
+// format:
+//   msr      MSR Cambridge CSV
+//            Timestamp,Hostname,DiskNumber,Type,Offset,Size,ResponseTime
+//            Timestamp in 100 ns ticks, Type Read | Write, Offset & Size in bytes
+//   spc      SNIA / UMass SPC CSV
+//            ASU,LBA,Size,Opcode,Timestamp
+//            LBA in 512 byte sectors, Size in bytes, Opcode r | w, Timestamp in s
+//   blkparse blkparse default text output, the queue (Q) events
+//            dev cpu seq time pid action rwbs sector + numSector [process]
+//
+// A request covers the pages of [offset, offset + size), each page is
+// taken modulo the logic page count; the first page carries the time since
+// the request before, in seconds, the others 0. Lines that are no request
+// (headers, other blkparse events, flushes, discards) are skipped.
+//
+// The input is cut into IMPORT_CHUNK byte ranges at line boundaries,
+// converted on numThread threads and written in order; at most
+// 2 * numThread chunks are in memory whatever the size of the input.
+
+static const long long IMPORT_CHUNK = 8 << 20;
+static const long long SECTOR_SIZE = 512;
+
+enum TraceFormat {
+    FORMAT_MSR,
+    FORMAT_SPC,
+    FORMAT_BLKPARSE
+};
+
+struct BlockRequest {
+    double time; // s
+    bool isWrite;
+    unsigned long long offset, size; // byte
+};
+
+struct ImportChunk {
+    std::vector<char> buffer; // encoded records
+    size_t numRecord;
+    TraceRecord firstRecord; // its interArrival is set by the writer
+    double firstTime, lastTime;
+    long long numRequest, numSkip;
+};
+
+/**
+ * @brief field : start of field index of a line split by delimiter,
+ *                NULL when the line has fewer fields
+ */
+static const char *field(const char *line, char delimiter, int index) {
+    for (; index > 0; --index) {
+        line = std::strchr(line, delimiter);
+        if (line == NULL) return NULL;
+        ++line;
+    }
+    return line;
+}
+
+static bool parseMsr(const char *line, BlockRequest &request) {
+    const char *type = field(line, ',', 3), *offset = field(line, ',', 4), *size = field(line, ',', 5);
+    if (size == NULL) return false;
+    char *end;
+    unsigned long long tick = strtoull(line, &end, 10);
+    if (end == line || *end != ',') return false;
+    request.time = tick * 1e-7;
+    if (std::strncmp(type, "Write,", 6) == 0) request.isWrite = true;
+    else if (std::strncmp(type, "Read,", 5) == 0) request.isWrite = false;
+    else return false;
+    request.offset = strtoull(offset, &end, 10);
+    if (end == offset) return false;
+    request.size = strtoull(size, &end, 10);
+    return end != size;
+}
+
+static bool parseSpc(const char *line, BlockRequest &request) {
+    const char *lba = field(line, ',', 1), *size = field(line, ',', 2),
+            *opcode = field(line, ',', 3), *time = field(line, ',', 4);
+    if (time == NULL) return false;
+    char *end;
+    request.offset = strtoull(lba, &end, 10) * SECTOR_SIZE;
+    if (end == lba) return false;
+    request.size = strtoull(size, &end, 10);
+    if (end == size) return false;
+    while (*opcode == ' ') ++opcode;
+    if (*opcode == 'w' || *opcode == 'W') request.isWrite = true;
+    else if (*opcode == 'r' || *opcode == 'R') request.isWrite = false;
+    else return false;
+    request.time = strtod(time, &end);
+    return end != time;
+}
+
+static bool parseBlkparse(const char *line, BlockRequest &request) {
+    char device[32], action[8], rwbs[8];
+    unsigned long long sector, numSector;
+    int cpu, pid;
+    long long sequence;
+    double time;
+    if (std::sscanf(line, "%31s %d %lld %lf %d %7s %7s %llu + %llu",
+                    device, &cpu, &sequence, &time, &pid, action, rwbs, &sector, &numSector) != 9) {
+        return false;
+    }
+    if (std::strcmp(action, "Q") != 0) return false;
+    // rwbs: [F preflush] op [F fua] [A] [S] [M], op R | W | D | DE | N;
+    // a flush alone is F or FN, so after the preflush only R and W are data
+    const char *op = rwbs;
+    if (*op == 'F') ++op;
+    if (*op == 'W') request.isWrite = true;
+    else if (*op == 'R') request.isWrite = false;
+    else return false;
+    request.time = time;
+    request.offset = sector * SECTOR_SIZE;
+    request.size = numSector * SECTOR_SIZE;
+    return true;
+}
+
+/**
+ * @brief readRange : the lines starting in [begin, end) of the file, each
+ *                    one ended by '\0' in place of its newline
+ */
+static bool readRange(std::ifstream &inStream, long long begin, long long end, std::vector<char> &text) {
+    long long start = begin > 0 ? begin - 1 : 0;
+    text.resize(end - start);
+    inStream.clear();
+    inStream.seekg(start);
+    inStream.read(&text[0], text.size());
+    if (inStream.gcount() != static_cast<std::streamsize>(text.size())) return false;
+
+    // the last line may run past end
+    char byte;
+    while (text.back() != '\n' && inStream.get(byte)) text.push_back(byte);
+    if (text.back() != '\n') text.push_back('\n');
+
+    // a line that starts before begin belongs to the chunk before
+    size_t skip = 0;
+    if (begin > 0) {
+        while (text[skip] != '\n') ++skip;
+        ++skip;
+    }
+    text.erase(text.begin(), text.begin() + skip);
+    for (size_t index = 0; index < text.size(); ++index) {
+        if (text[index] == '\n') text[index] = '\0';
+    }
+    return true;
+}
+
+static void convertChunk(TraceFormat format, int bytePerPage, int numLogicPage,
+                         std::vector<char> &text, ImportChunk &chunk) {
+    chunk.buffer.clear();
+    chunk.numRecord = 0;
+    chunk.numRequest = chunk.numSkip = 0;
+
+    BlockRequest request;
+    TraceRecord record;
+    double lastTime = 0;
+    for (size_t lineBegin = 0; lineBegin < text.size(); lineBegin += std::strlen(&text[lineBegin]) + 1) {
+        const char *line = &text[lineBegin];
+        if (*line == '\0' || *line == '\r') continue;
+
+        bool isOk = false;
+        switch (format) {
+        case FORMAT_MSR: isOk = parseMsr(line, request); break;
+        case FORMAT_SPC: isOk = parseSpc(line, request); break;
+        case FORMAT_BLKPARSE: isOk = parseBlkparse(line, request); break;
+        }
+        if (isOk == false || request.size == 0) {
+            ++chunk.numSkip;
+            continue;
+        }
+
+        if (chunk.numRequest == 0) chunk.firstTime = lastTime = request.time;
+        record.m_isWrite = request.isWrite;
+        record.m_interArrival = static_cast<float>(std::max(0.0, request.time - lastTime));
+        lastTime = request.time;
+        ++chunk.numRequest;
+
+        unsigned long long firstPage = request.offset / bytePerPage,
+                lastPage = (request.offset + request.size - 1) / bytePerPage;
+        for (unsigned long long page = firstPage; page <= lastPage; ++page) {
+            record.m_logicNum = static_cast<int>(page % numLogicPage);
+            if (chunk.numRecord == 0) chunk.firstRecord = record;
+            chunk.buffer.resize((chunk.numRecord + 1) * TRACE_RECORD_SIZE);
+            encodeTraceRecord(record, &chunk.buffer[chunk.numRecord * TRACE_RECORD_SIZE]);
+            ++chunk.numRecord;
+            record.m_interArrival = 0;
+        }
+    }
+    chunk.lastTime = lastTime;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 5 && argc != 6) {
+        std::cerr << "usage: " << argv[0] << " msr|spc|blkparse configFile inputFile outputFile [numThread]"
+                  << std::endl;
+        return 1;
+    }
+
+    TraceFormat format;
+    std::string formatName = argv[1];
+    if (formatName == "msr") format = FORMAT_MSR;
+    else if (formatName == "spc") format = FORMAT_SPC;
+    else if (formatName == "blkparse") format = FORMAT_BLKPARSE;
+    else {
+        std::cerr << "Unknown trace format " << formatName << std::endl;
+        return 1;
+    }
+
+    int bytePerPage, numLogicPage;
+    if (readTraceGeometry(argv[2], bytePerPage, numLogicPage) == false) return 1;
+    if (bytePerPage < 1 || numLogicPage < 1) {
+        std::cerr << "Empty logic space in " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::ifstream inStream;
+    inStream.open(argv[3], std::ios_base::in | std::ios_base::binary);
+    if (inStream.is_open() == false) {
+        std::cerr << "Fail open input trace " << argv[3] << std::endl;
+        return 1;
+    }
+    inStream.seekg(0, std::ios_base::end);
+    long long fileSize = static_cast<long long>(inStream.tellg());
+    inStream.close();
+
+    int numThread = argc == 6 ? atoi(argv[5]) : 0;
+    if (numThread < 1) numThread = static_cast<int>(std::thread::hardware_concurrency());
+    if (numThread < 1) numThread = 1;
+
+    TraceWriter traceWriter;
+    if (traceWriter.open(argv[4]) == false) return 2;
+
+    // workers take the byte ranges in any order, the writer takes them in
+    // order; a worker waits while its chunk is window chunks ahead
+    long long numChunk = (fileSize + IMPORT_CHUNK - 1) / IMPORT_CHUNK;
+    int window = 2 * numThread;
+    std::vector<ImportChunk> slot(window);
+    std::vector<long long> slotChunk(window, -1);
+    long long numWritten = 0;
+    std::atomic<bool> isReadOk(true);
+    std::mutex mutex;
+    std::condition_variable slotCond;
+
+    std::atomic<long long> nextChunk(0);
+    std::vector<std::thread> workerArr;
+    for (int threadIndex = 0; threadIndex < numThread; ++threadIndex) {
+        workerArr.push_back(std::thread([&]() {
+            std::ifstream chunkStream;
+            chunkStream.open(argv[3], std::ios_base::in | std::ios_base::binary);
+            std::vector<char> text;
+            ImportChunk chunk;
+            for (long long chunkIndex = nextChunk++; chunkIndex < numChunk; chunkIndex = nextChunk++) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    slotCond.wait(lock, [&]() { return chunkIndex < numWritten + window; });
+                }
+                long long begin = chunkIndex * IMPORT_CHUNK, end = std::min(fileSize, begin + IMPORT_CHUNK);
+                if (chunkStream.is_open() && readRange(chunkStream, begin, end, text)) {
+                    convertChunk(format, bytePerPage, numLogicPage, text, chunk);
+                } else {
+                    isReadOk = false;
+                    chunk.buffer.clear();
+                    chunk.numRecord = 0;
+                    chunk.numRequest = chunk.numSkip = 0;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                int slotIndex = static_cast<int>(chunkIndex % window);
+                std::swap(slot[slotIndex], chunk);
+                slotChunk[slotIndex] = chunkIndex;
+                slotCond.notify_all();
+            }
+        }));
+    }
+
+    bool isOk = true;
+    bool hasTime = false;
+    double lastTime = 0;
+    long long numRequest = 0, numSkip = 0;
+    ImportChunk chunk;
+    for (long long chunkIndex = 0; chunkIndex < numChunk; ++chunkIndex) {
+        int slotIndex = static_cast<int>(chunkIndex % window);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotCond.wait(lock, [&]() { return slotChunk[slotIndex] == chunkIndex; });
+            std::swap(chunk, slot[slotIndex]);
+            slotChunk[slotIndex] = -1;
+            numWritten = chunkIndex + 1;
+            slotCond.notify_all();
+        }
+        numRequest += chunk.numRequest;
+        numSkip += chunk.numSkip;
+        if (chunk.numRecord == 0) continue;
+
+        // the first request of the trace starts at time 0
+        chunk.firstRecord.m_interArrival = hasTime ? static_cast<float>(std::max(0.0, chunk.firstTime - lastTime)) : 0;
+        encodeTraceRecord(chunk.firstRecord, &chunk.buffer[0]);
+        hasTime = true;
+        lastTime = chunk.lastTime;
+        if (isOk) isOk = traceWriter.appendEncoded(&chunk.buffer[0], chunk.numRecord);
+    }
+    for (int index = 0; index < workerArr.size(); ++index) workerArr[index].join();
+
+    if (isReadOk == false) {
+        std::cerr << "Fail read input trace " << argv[3] << std::endl;
+        isOk = false;
+    }
+    isOk = traceWriter.close() && isOk;
+    if (isOk == false) {
+        std::cerr << "Fail import trace " << argv[4] << std::endl;
+        return 2;
+    }
+    std::cout << numRequest << " requests, " << traceWriter.getNumRecord() << " pages, "
+              << numSkip << " lines skipped" << std::endl;
+    return 0;
+}
@@ -1,51 +1,224 @@
-#include <cstdlib>
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <map>
-
-
-int main(int ac, char **av) {
-    if (ac != 4) {
-        std::cerr << "wrong argument \n";
-        return 1;
-    }
-    double tmpValue;
-
-    int numLevel = std::atoi(av[2]),
-            numBlock = std::atoi(av[3]);
-
-    std::ofstream outStream;
-    outStream.open("temperCal", std::ios_base::out);
-
-    for (int times = 0; true; ++times) {
-        double avTemper = 0;
-        std::map<double, bool> mapTemper;
-
-        for (int levelIndex = 0; levelIndex < numLevel; ++levelIndex) {
-            std::ostringstream inFilenameStream;
-            inFilenameStream << av[1] <<"_" << times << "_" << levelIndex;
-            std::string inFilename = inFilenameStream.str();
-
-            std::ifstream inStream;
-            inStream.open(inFilename.c_str(), std::ios_base::in);
-            if (inStream.is_open() == false) {
-                return 0;
-            }
-            while (inStream.eof() == false){
-                inStream >> tmpValue;
-                avTemper += tmpValue / numBlock;
-                mapTemper[tmpValue] = true;
-            }
-            inStream.close();
-        }
-
-        std::map<double, bool>::iterator iterTemper = mapTemper.end();
-        --iterTemper;
-
-        outStream << avTemper << "\t" << iterTemper->first << "\n";
-    }
-
-    outStream.close();
-    return 0;
-}
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streaming analyzer of the temperature snapshots written by
+// Executor::statisticTemper (prefix_times_level, one value per block,
+// one blank line after every line of blocks).
+//
+// usage: transfertemper prefix numLevel numBlock [threshold] [numThread] [scanInterval]
+//
+// temperCal    : times avg max p50 p90 p99 numBlockAbove timeAbove
+// temperHotspot: times level line block temper
+
+struct LevelHotspot {
+    int line;
+    int block;
+    double temper;
+};
+
+struct FrameStat {
+    bool isValid;
+    double avgTemper;
+    double maxTemper;
+    double p50Temper;
+    double p90Temper;
+    double p99Temper;
+    int numBlockAbove;
+    std::vector<LevelHotspot> hotspot;
+};
+
+static std::string frameFilename(const char *prefix, int times, int levelIndex) {
+    std::ostringstream filenameStream;
+    filenameStream << prefix << "_" << times << "_" << levelIndex;
+    return filenameStream.str();
+}
+
+static bool frameExist(const char *prefix, int times) {
+    std::FILE *file = std::fopen(frameFilename(prefix, times, 0).c_str(), "rb");
+    if (file == NULL) return false;
+    std::fclose(file);
+    return true;
+}
+
+static bool readWholeFile(const std::string &filename, std::vector<char> &buffer) {
+    std::FILE *file = std::fopen(filename.c_str(), "rb");
+    if (file == NULL) return false;
+
+    std::fseek(file, 0, SEEK_END);
+    long fileSize = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+
+    buffer.resize(fileSize + 1);
+    size_t readSize = std::fread(&buffer[0], 1, fileSize, file);
+    std::fclose(file);
+
+    buffer[readSize] = '\0';
+    return true;
+}
+
+/**
+ * @brief parse one level file, a blank line separates two lines of blocks
+ */
+static void parseLevel(std::vector<char> &buffer, std::vector<double> &temperArr,
+                       LevelHotspot &hotspot) {
+    char *pos = &buffer[0], *end = NULL;
+    int lineIndex = 0, blockIndex = 0, numNewLine = 0;
+    bool firstValue = true;
+
+    hotspot.line = hotspot.block = -1;
+    hotspot.temper = 0;
+
+    while (*pos != '\0') {
+        if (*pos == '\n') {
+            ++numNewLine;
+            ++pos;
+            continue;
+        }
+        if (*pos == ' ' || *pos == '\t' || *pos == '\r') {
+            ++pos;
+            continue;
+        }
+
+        double temper = std::strtod(pos, &end);
+        if (end == pos) break;
+        pos = end;
+
+        if (firstValue == false && numNewLine >= 2) {
+            ++lineIndex;
+            blockIndex = 0;
+        } else if (firstValue == false) {
+            ++blockIndex;
+        }
+        firstValue = false;
+        numNewLine = 0;
+
+        if (hotspot.line == -1 || temper > hotspot.temper) {
+            hotspot.line = lineIndex;
+            hotspot.block = blockIndex;
+            hotspot.temper = temper;
+        }
+        temperArr.push_back(temper);
+    }
+}
+
+static double percentile(std::vector<double> &temperArr, double ratio) {
+    size_t index = static_cast<size_t>(ratio * (temperArr.size() - 1));
+    std::nth_element(temperArr.begin(), temperArr.begin() + index, temperArr.end());
+    return temperArr[index];
+}
+
+static void analyzeFrame(const char *prefix, int times, int numLevel, int numBlock,
+                         double threshold, FrameStat &frameStat) {
+    std::vector<char> buffer;
+    std::vector<double> temperArr;
+    temperArr.reserve(numBlock);
+
+    frameStat.isValid = false;
+    frameStat.hotspot.resize(numLevel);
+    for (int levelIndex = 0; levelIndex < numLevel; ++levelIndex) {
+        if (readWholeFile(frameFilename(prefix, times, levelIndex), buffer) == false) {
+            std::cerr << "Fail open snapshot " << frameFilename(prefix, times, levelIndex) << std::endl;
+            return;
+        }
+        parseLevel(buffer, temperArr, frameStat.hotspot[levelIndex]);
+    }
+    if (temperArr.empty()) return;
+
+    double sumTemper = 0, maxTemper = temperArr[0];
+    int numBlockAbove = 0;
+    for (size_t index = 0; index < temperArr.size(); ++index) {
+        sumTemper += temperArr[index];
+        if (temperArr[index] > maxTemper) maxTemper = temperArr[index];
+        if (temperArr[index] >= threshold) ++numBlockAbove;
+    }
+
+    frameStat.avgTemper = sumTemper / numBlock;
+    frameStat.maxTemper = maxTemper;
+    frameStat.numBlockAbove = numBlockAbove;
+    // nth_element reorders the array, go from the highest rank down
+    frameStat.p99Temper = percentile(temperArr, 0.99);
+    frameStat.p90Temper = percentile(temperArr, 0.90);
+    frameStat.p50Temper = percentile(temperArr, 0.50);
+    frameStat.isValid = true;
+}
+
+int main(int ac, char **av) {
+    if (ac < 4 || ac > 7) {
+        std::cerr << "usage: " << av[0]
+                  << " prefix numLevel numBlock [threshold] [numThread] [scanInterval]\n";
+        return 1;
+    }
+
+    int numLevel = std::atoi(av[2]),
+            numBlock = std::atoi(av[3]);
+    double threshold = ac > 4 ? std::atof(av[4]) : 85;
+    int numThread = ac > 5 ? std::atoi(av[5]) : static_cast<int>(std::thread::hardware_concurrency());
+    double scanInterval = ac > 6 ? std::atof(av[6]) : 1;
+
+    if (numLevel < 1 || numBlock < 1) {
+        std::cerr << "wrong argument \n";
+        return 1;
+    }
+    if (numThread < 1) numThread = 1;
+
+    int numFrame = 0;
+    while (frameExist(av[1], numFrame)) ++numFrame;
+
+    std::vector<FrameStat> frameStatArr(numFrame);
+    std::atomic<int> nextFrame(0);
+    std::vector<std::thread> workerArr;
+    for (int threadIndex = 0; threadIndex < numThread && threadIndex < numFrame; ++threadIndex) {
+        workerArr.push_back(std::thread([&]() {
+            for (int times = nextFrame++; times < numFrame; times = nextFrame++) {
+                analyzeFrame(av[1], times, numLevel, numBlock, threshold, frameStatArr[times]);
+            }
+        }));
+    }
+    for (size_t index = 0; index < workerArr.size(); ++index) {
+        workerArr[index].join();
+    }
+
+    std::ofstream outStream, hotspotStream;
+    outStream.open("temperCal", std::ios_base::out);
+    hotspotStream.open("temperHotspot", std::ios_base::out);
+    if (outStream.is_open() == false || hotspotStream.is_open() == false) {
+        std::cerr << "Fail open output file \n";
+        return 2;
+    }
+
+    double timeAbove = 0;
+    for (int times = 0; times < numFrame; ++times) {
+        const FrameStat &frameStat = frameStatArr[times];
+        if (frameStat.isValid == false) break;
+
+        if (frameStat.maxTemper >= threshold) timeAbove += scanInterval;
+
+        outStream << times << "\t"
+                  << frameStat.avgTemper << "\t"
+                  << frameStat.maxTemper << "\t"
+                  << frameStat.p50Temper << "\t"
+                  << frameStat.p90Temper << "\t"
+                  << frameStat.p99Temper << "\t"
+                  << frameStat.numBlockAbove << "\t"
+                  << timeAbove << "\n";
+
+        for (int levelIndex = 0; levelIndex < numLevel; ++levelIndex) {
+            const LevelHotspot &hotspot = frameStat.hotspot[levelIndex];
+            hotspotStream << times << "\t" << levelIndex << "\t"
+                          << hotspot.line << "\t" << hotspot.block << "\t"
+                          << hotspot.temper << "\n";
+        }
+    }
+
+    outStream.close();
+    hotspotStream.close();
+    return 0;
+}